@@ -277,6 +277,18 @@ private:
 	///
 	void handleLedDeviceCommand(const QJsonObject &message, const QString &command, int tan);
 
+	/// Handle an incoming JSON Latency message, returns or resets the frame latency statistic of the instance
+	///
+	/// @param message the incoming message
+	///
+	void handleLatencyCommand(const QJsonObject &message, const QString &command, int tan);
+
+	/// Handle an incoming JSON Tracing message, starts/stops the runtime tracing or exports the recorded spans
+	///
+	/// @param message the incoming message
+	///
+	void handleTracingCommand(const QJsonObject &message, const QString &command, int tan);
+
 	///
 	/// Handle an incoming JSON message of unknown type
 	///
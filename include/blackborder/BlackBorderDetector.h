@@ -62,6 +62,11 @@ namespace hyperion
 
 		uint8_t calculateThreshold(double blackborderThreshold) const;
 
+		///
+		/// @return The threshold [0 .. 255] below which a color is considered black
+		///
+		uint8_t threshold() const { return _blackborderThreshold; }
+
 		///
 		/// default detection mode (3lines 4side detection)
 		template <typename Pixel_T>
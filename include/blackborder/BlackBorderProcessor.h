@@ -10,6 +10,7 @@
 
 // Local Hyperion includes
 #include "BlackBorderDetector.h"
+#include <hyperion/FrameStage.h>
 
 class Hyperion;
 
@@ -37,6 +38,13 @@ namespace hyperion
 		///
 		bool enabled() const;
 
+		///
+		/// Return true when the detection has settled on the current border, processing the
+		/// last image again would not change the current border
+		/// @return True if settled
+		///
+		bool isSettled() const { return _previousDetectedBorder == _currentBorder && _inconsistentCnt == 0; }
+
 		///
 		/// Set activation state of black border detector
 		/// @param enable current state
@@ -73,13 +81,8 @@ namespace hyperion
 				return true;
 			}
 
-			if (_detectionMode == "default") {
-				imageBorder = _detector->process(image);
-			} else if (_detectionMode == "classic") {
-				imageBorder = _detector->process_classic(image);
-			} else if (_detectionMode == "osd") {
-				imageBorder = _detector->process_osd(image);
-			}
+			imageBorder = detectBorder(image);
+
 			// add blur to the border
 			if (imageBorder.horizontalSize > 0)
 			{
@@ -110,6 +113,34 @@ namespace hyperion
 		/// Hyperion instance
 		Hyperion* _hyperion;
 
+		///
+		/// Runs the detector of the configured mode on the image
+		///
+		/// @param image The image
+		/// @return The border of the image
+		///
+		template <typename Pixel_T>
+		BlackBorder detectBorder(const Image<Pixel_T> & image) const
+		{
+			switch (_detectionModeId)
+			{
+				case FrameStage::DETECTION_CLASSIC: return _detector->process_classic(image);
+				case FrameStage::DETECTION_OSD:     return _detector->process_osd(image);
+				default:                            return _detector->process(image);
+			}
+		}
+
+		///
+		/// Detects the border of a captured image once for all instances with the same detector settings
+		///
+		/// @param image The image
+		/// @return The border of the image
+		///
+		BlackBorder detectBorder(const Image<ColorRgb> & image) const
+		{
+			return FrameStage::getInstance()->detectBorder(image, *_detector, _detectionModeId);
+		}
+
 		///
 		/// Updates the current border based on the newly detected border. Returns true if the
 		/// current border has changed.
@@ -136,6 +167,7 @@ namespace hyperion
 
 		/// The border detection mode
 		QString _detectionMode;
+		FrameStage::DetectionMode _detectionModeId;
 
 		/// The blackborder detector
 		BlackBorderDetector* _detector;
@@ -3,27 +3,25 @@
 // stl includes
 #include <vector>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 // Qt includes
 #include <QObject>
-#include <QSocketNotifier>
+#include <QThread>
 #include <QRectF>
 #include <QMap>
 #include <QMultiMap>
 
 // util includes
 #include <utils/PixelFormat.h>
+#include <utils/CaptureRateController.h>
 #include <hyperion/Grabber.h>
 #include <grabber/VideoStandard.h>
 #include <utils/Components.h>
 #include <cec/CECEvent.h>
 
-// general JPEG decoder includes
-#ifdef HAVE_JPEG_DECODER
-	#include <QImage>
-	#include <QColor>
-#endif
-
 // System JPEG decoder
 #ifdef HAVE_JPEG
 	#include <jpeglib.h>
@@ -35,6 +33,9 @@
 	#include <turbojpeg.h>
 #endif
 
+struct v4l2_buffer;
+struct v4l2_format;
+
 /// Capture class for V4L2 devices
 ///
 /// @see http://linuxtv.org/downloads/v4l-dvb-apis/capture-example.html
@@ -68,6 +69,7 @@ public:
 	}
 
 	bool getSignalDetectionEnabled() const { return _signalDetectionEnabled; }
+	bool getAutoFormat() const { return _autoFormat; }
 	bool getCecDetectionEnabled() const { return _cecDetectionEnabled; }
 
 	int grabFrame(Image<ColorRgb> &);
@@ -105,6 +107,25 @@ public:
 	///
 	void setCecDetectionEnable(bool enable) override;
 
+	///
+	/// @brief Negotiate the pixel format and resolution automatically, the cheapest format with a resolution
+	///        which is sufficient for the led layouts is captured instead of the configured ones
+	/// @param enable  True to negotiate
+	///
+	void setAutoFormat(bool enable);
+
+	///
+	/// @brief Set the pixel format which is requested from the device, restarts the capture on a change
+	/// @param pixelFormat  The pixel format, NO_CHANGE keeps the format of the device
+	///
+	void setPixelFormat(PixelFormat pixelFormat);
+
+	///
+	/// @brief Lower the processing rate while the picture is static, without signal or in standby
+	/// @param enable  True to adapt the rate, false to process each frame
+	///
+	void setAdaptiveRate(bool enable);
+
 	///
 	/// @brief overwrite Grabber.h implementation
 	///
@@ -130,6 +151,13 @@ public:
 	///
 	QStringList getV4L2devices() const override;
 
+	///
+	/// @brief Get the path of a configured device, the opened device once the grabber is initialized
+	/// @param device  The configured device: a path, the name of a device or "auto" for the first device
+	/// @return The path, the configured device if no device matches
+	///
+	QString getDevicePath(const QString& device) const;
+
 	///
 	/// @brief overwrite Grabber.h implementation
 	///
@@ -163,9 +191,73 @@ signals:
 	void readError(const char* err);
 
 private slots:
-	int read_frame();
+	///
+	/// @brief Process the latest frame of the capture thread
+	///
+	void processFrame();
+
+	///
+	/// @brief Stop the grabber after the capture thread failed to dequeue a frame
+	///
+	void handleDequeueError();
+
+	///
+	/// @brief Forward an exception of the capture thread with readError()
+	///
+	void handleReadError(const QString& error);
 
 private:
+	///
+	/// @brief Capture loop of the capture thread, waits for frames and hands them to processFrame()
+	///        until _captureRunning is cleared
+	///
+	void capture();
+
+	///
+	/// @brief Dequeue a frame and hand it to processFrame(). Runs in the capture thread.
+	/// @return -1 on a dequeue error which stops the capture, 1 if a frame was captured, else 0
+	///
+	int read_frame();
+
+	///
+	/// @brief Hand a captured frame to processFrame(), replaces a pending frame which was not processed yet
+	/// @param p            The frame
+	/// @param size         The size of the frame
+	/// @param captureTime  The time of the dequeue
+	/// @param lease        The lease of the driver buffer holding the frame, the frame is copied without lease
+	///
+	void postFrame(const void *p, int size, int64_t captureTime, std::shared_ptr<const uint8_t> lease);
+
+	///
+	/// @brief Check if the picture of a raw frame changed while the rate is lowered. Runs in the capture thread.
+	/// @param data  The frame
+	/// @param size  The size of the frame
+	/// @return True if the picture changed, false if it's static or can't be sampled. MJPEG is sampled on a 1/8 luma decode
+	///
+	bool rawFrameChanged(const uint8_t * data, int size);
+
+	///
+	/// @brief Publish the processing interval of the rate controller to the capture thread
+	///
+	void updateProcessingRate();
+
+	///
+	/// @brief Lease a dequeued driver buffer, the buffer is requeued when the last reference is released
+	/// @param buf  The dequeued buffer
+	/// @return The lease of the buffer data
+	///
+	std::shared_ptr<const uint8_t> leaseBuffer(const v4l2_buffer& buf);
+
+	///
+	/// @brief Get an output image of the pool which is not referenced by the consumers of a previous frame anymore
+	/// @return The image, its size and pixels are the ones of an earlier frame
+	///
+	Image<ColorRgb>& acquireImage();
+
+	void startCaptureThread();
+
+	void stopCaptureThread();
+
 	void getV4Ldevices();
 
 	bool init();
@@ -184,15 +276,60 @@ private:
 
 	void init_device(VideoStandard videoStandard);
 
+	///
+	/// @brief Choose the cheapest pixel format and resolution of the device which provides the resolution required by
+	///        the led layouts (CaptureRegion) with the pixel decimation and cropping at the configured frame rate.
+	///        Without a sufficient resolution the largest one is chosen.
+	/// @param[in,out] fmt  The format to set
+	/// @return False if the led layouts are unknown or the device enumerates no supported format
+	///
+	bool negotiateFormat(v4l2_format& fmt);
+
+	///
+	/// @brief Check if the device captures a pixel format and resolution with the configured frame rate
+	/// @return True if the frame rate is supported or if the device doesn't enumerate frame intervals
+	///
+	bool supportsFramerate(unsigned pixelFormat, unsigned width, unsigned height);
+
 	void uninit_device();
 
 	void start_capturing();
 
 	void stop_capturing();
 
-	bool process_image(const void *p, int size);
+	bool process_image(const void *p, int size, int64_t captureTime, unsigned frameSpan);
 
-	void process_image(const uint8_t *p, int size);
+	///
+	/// @param frameSpan  The number of captured frames the frame stands for, including the dropped and replaced ones
+	///
+	void process_image(const uint8_t *p, int size, int64_t captureTime, unsigned frameSpan);
+
+#ifdef HAVE_JPEG_DECODER
+	///
+	/// @brief Decode a MJPEG frame at the reduced size of the pixel decimation and resample it
+	/// @param data   The frame
+	/// @param size   The size of the frame
+	/// @param image  The decoded image
+	/// @return False if the frame is corrupted
+	///
+	bool decodeJpeg(const uint8_t *data, int size, Image<ColorRgb> &image);
+
+	///
+	/// @brief Decode the luma of a MJPEG frame at 1/8 size (DC coefficients only) into _lumaBuffer.
+	///        Runs in the capture thread with its own decompressor.
+	/// @param data    The frame
+	/// @param size    The size of the frame
+	/// @param width   The width of the decoded luma
+	/// @param height  The height of the decoded luma
+	/// @return False if the frame is corrupted
+	///
+	bool decodeJpegLuma(const uint8_t *data, int size, int &width, int &height);
+#endif
+
+	///
+	/// @brief Convert only the image areas which are read by the led layouts and the signal detection (CaptureRegion)
+	///
+	void updateCaptureRegion();
 
 	int xioctl(int request, void *arg);
 
@@ -240,17 +377,31 @@ private:
 		// Suppress fprintf warnings.
 	}
 
-	jpeg_decompress_struct* _decompress;
-	errorManager* _error;
+	jpeg_decompress_struct* _decompress = nullptr;
+	errorManager* _error = nullptr;
+	// the decompressor of the capture thread for the change detection
+	jpeg_decompress_struct* _lumaDecompress = nullptr;
+	errorManager* _lumaError = nullptr;
 #endif
 
 #ifdef HAVE_TURBO_JPEG
 	tjhandle _decompress = nullptr;
 	int _subsamp;
+	// the decompressor of the capture thread for the change detection
+	tjhandle _lumaDecompress = nullptr;
+#endif
+
+#ifdef HAVE_JPEG_DECODER
+	/// the decoded frame if it's cropped or decimated further, kept across frames
+	std::vector<uint8_t> _decodeBuffer;
+	/// the 1/8 luma of a dropped frame, kept across frames
+	std::vector<uint8_t> _lumaBuffer;
 #endif
 
 private:
 	QString _deviceName;
+	// the enumerated devices are written in the thread of the grabber and read by the getters from any thread
+	mutable std::mutex _deviceMutex;
 	std::map<QString, QString> _v4lDevices;
 	QMap<QString, V4L2Grabber::DeviceProperties> _deviceProperties;
 
@@ -259,7 +410,9 @@ private:
 	int                 _fileDescriptor;
 	std::vector<buffer> _buffers;
 
+	/// the captured pixel format and the one of the configuration which is requested from the device
 	PixelFormat _pixelFormat;
+	PixelFormat _requestedPixelFormat;
 	int         _pixelDecimation;
 	int         _lineLength;
 	int         _frameByteSize;
@@ -277,7 +430,41 @@ private:
 	double   _x_frac_max;
 	double   _y_frac_max;
 
-	QSocketNotifier *_streamNotifier;
+	// negotiate the pixel format and resolution
+	bool _autoFormat;
+
+	// the generation of the CaptureRegion which is applied to the resampler
+	unsigned _captureRegionGeneration;
+	bool     _captureRegionValid;
+
+	// the capture thread dequeues the frames, processFrame() decodes them in the thread of the grabber
+	QThread*          _captureThread;
+	std::atomic<bool> _captureRunning;
+
+	// the latest captured frame which is not processed yet. It's processed in the leased driver buffer or,
+	// without lease, copied to _pendingFrame which is swapped with _processingFrame
+	std::mutex                     _frameMutex;
+	std::shared_ptr<const uint8_t> _pendingLease;
+	std::vector<uint8_t>           _pendingFrame;
+	int                            _pendingFrameSize;
+	int64_t                        _pendingFrameTime;
+	unsigned                       _pendingFrameSpan;
+	bool                           _framePending;
+	std::vector<uint8_t>           _processingFrame;
+
+	// the output images, an image is reused when the consumers released it, _nextPoolImage is replaced if all are in use
+	std::vector<Image<ColorRgb>> _imagePool;
+	size_t                       _nextPoolImage;
+
+	// lowers the processing rate while the picture is static or without signal, used by the thread of the grabber.
+	// The capture thread drops the frames until the published interval passed, _lastPostTime and _droppedFrames are its own.
+	// It samples the dropped frames into _lumaSamples and resets the interval when the picture changed
+	CaptureRateController _rateController;
+	std::atomic<int64_t>  _processingInterval;
+	int64_t               _lastPostTime;
+	unsigned              _droppedFrames;
+	std::vector<uint8_t>  _lumaSamples;
+	bool                  _adaptiveRate;
 
 	bool _initialized;
 	bool _deviceAutoDiscoverEnabled;
@@ -3,6 +3,8 @@
 #include <hyperion/GrabberWrapper.h>
 #include <grabber/V4L2Grabber.h>
 
+class QThread;
+
 class V4L2Wrapper : public GrabberWrapper
 {
 	Q_OBJECT
@@ -15,12 +17,36 @@ public:
 			const unsigned input,
 			VideoStandard videoStandard,
 			PixelFormat pixelFormat,
-			int pixelDecimation );
+			int pixelDecimation,
+			bool additionalDevice = false );
 	~V4L2Wrapper() override;
 
 	bool getSignalDetectionEnable() const;
 	bool getCecDetectionEnable() const;
 
+	///
+	/// @brief Process the frames in the given thread, the wrapper and the grabber are moved to it.
+	///        Each device has its own thread, the frames of several devices are processed concurrently.
+	/// @param thread  The thread
+	///
+	void moveToProcessingThread(QThread* thread);
+
+	///
+	/// @brief Get the path of a configured device, the opened device once the grabber is initialized
+	/// @param device  The configured device: a path, the name of a device or "auto" for the first device
+	/// @return The path, the configured device if no device matches
+	///
+	QString getDevicePath(const QString& device) const { return _grabber.getDevicePath(device); }
+
+	///
+	/// @brief Get the settings of an additional device, its device settings (device, input, standard,
+	///        width, height, fps) override the ones of the primary device
+	/// @param config  The v4l2 settings
+	/// @param device  The path of the additional device
+	/// @return The settings of the device, empty if the device is not configured
+	///
+	static QJsonObject additionalDeviceConfig(const QJsonObject& config, const QString& device);
+
 public slots:
 	bool start() override;
 	void stop() override;
@@ -29,6 +55,9 @@ public slots:
 	void setCropping(unsigned cropLeft, unsigned cropRight, unsigned cropTop, unsigned cropBottom) override;
 	void setSignalDetectionOffset(double verticalMin, double horizontalMin, double verticalMax, double horizontalMax);
 	void setSignalDetectionEnable(bool enable);
+	void setAverageDecimation(bool enable);
+	void setAutoFormat(bool enable);
+	void setAdaptiveRate(bool enable) override;
 	void setCecDetectionEnable(bool enable);
 	void setDeviceVideoStandard(const QString& device, VideoStandard videoStandard);
 	void handleCecEvent(CECEvent event);
@@ -43,4 +72,7 @@ private slots:
 private:
 	/// The V4L2 grabber
 	V4L2Grabber _grabber;
+
+	/// The path of an additional device, empty for the primary device
+	const QString _additionalDevice;
 };
@@ -4,6 +4,10 @@
 #include <utils/settings.h>
 #include <utils/Components.h>
 #include <utils/Image.h>
+#include <utils/FrameMailbox.h>
+
+// stl
+#include <memory>
 
 class Hyperion;
 class QTimer;
@@ -17,10 +21,16 @@ class CaptureCont : public QObject
 	Q_OBJECT
 public:
 	CaptureCont(Hyperion* hyperion);
+	~CaptureCont() override;
 
 	void setSystemCaptureEnable(bool enable);
 	void setV4LCaptureEnable(bool enable);
 
+	///
+	/// @brief Get the number of captured images which were replaced by a newer one before this instance processed them
+	///
+	quint64 getCoalescedFrames() const { return _systemMailbox->coalescedFrames() + _v4lMailbox->coalescedFrames(); }
+
 private slots:
 	///
 	/// @brief Handle component state change of V4L and SystemCapture
@@ -67,10 +77,16 @@ private:
 	quint8 _systemCaptPrio;
 	QString _systemCaptName;
 	QTimer* _systemInactiveTimer;
+	/// Latest system image, filled by the grabber thread. Shared with the posting grabber thread, deleted in the thread of the instance
+	std::shared_ptr<FrameMailbox> _systemMailbox;
 
 	/// Reflect state of v4l capture and prio
 	bool _v4lCaptEnabled;
 	quint8 _v4lCaptPrio;
+	/// The requested v4l device (path), empty for any device
+	QString _v4lDevice;
 	QString _v4lCaptName;
 	QTimer* _v4lInactiveTimer;
+	/// Latest v4l image, filled by the grabber threads. Shared with the posting grabber thread, deleted in the thread of the instance
+	std::shared_ptr<FrameMailbox> _v4lMailbox;
 };
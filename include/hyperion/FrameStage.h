@@ -0,0 +1,113 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Utils includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+// Black border includes
+#include <blackborder/BlackBorderDetector.h>
+
+///
+/// @brief Shared per frame stage for all Hyperion instances. Instances which listen to the same
+/// capture source receive the same (implicitly shared) image. The data which does not depend on the
+/// instance (image fingerprint, black border detection per detector setting) is computed by the first
+/// instance and handed to the others. Frames are identified by their capture sequence number and
+/// pixel buffer, unstamped images (effects, json) are processed without caching.
+///
+class FrameStage
+{
+public:
+	/// Black border detection modes, matches the "mode" setting of the blackborder detector
+	enum DetectionMode
+	{
+		DETECTION_DEFAULT,
+		DETECTION_CLASSIC,
+		DETECTION_OSD
+	};
+
+	static FrameStage* getInstance()
+	{
+		static FrameStage instance;
+		return & instance;
+	}
+
+	FrameStage(FrameStage const&)      = delete;
+	void operator=(FrameStage const&) = delete;
+
+	///
+	/// @brief Get the fingerprint of an image (see ImageHash), computed once per frame
+	/// @param image  The image
+	/// @return The fingerprint
+	///
+	uint64_t imageHash(const Image<ColorRgb>& image);
+
+	///
+	/// @brief Get the black border of an image, detected once per frame and detector setting
+	/// @param image     The image
+	/// @param detector  The detector to use
+	/// @param mode      The detection mode
+	/// @return The detected (or not detected) black border
+	///
+	hyperion::BlackBorder detectBorder(const Image<ColorRgb>& image, const hyperion::BlackBorderDetector& detector, DetectionMode mode);
+
+	///
+	/// @brief Number of requests which were answered from the data of another instance
+	///
+	uint64_t hits() const { return _hits.load(std::memory_order_relaxed); }
+
+	///
+	/// @brief Number of requests which required a computation
+	///
+	uint64_t misses() const { return _misses.load(std::memory_order_relaxed); }
+
+private:
+	FrameStage();
+
+	/// Detected border of a frame for a detector setting
+	struct BorderResult
+	{
+		uint8_t threshold;
+		DetectionMode mode;
+		hyperion::BlackBorder border;
+	};
+
+	/// Shared data of a single frame, guarded by its own mutex so different sources do not block each other
+	struct FrameData
+	{
+		std::mutex mutex;
+		bool hashValid = false;
+		uint64_t hash = 0;
+		std::vector<BorderResult> borders;
+	};
+
+	///
+	/// @brief Get the shared data of a frame, creates it for a new frame and evicts the oldest frame
+	/// @param image  The image
+	/// @return The shared data, nullptr for unstamped images
+	///
+	std::shared_ptr<FrameData> frameData(const Image<ColorRgb>& image);
+
+	/// frames kept, enough for a few sources with frames in flight
+	static const size_t CACHE_SIZE = 8;
+
+	struct Entry
+	{
+		uint64_t sequence;
+		const void* pixels;
+		std::shared_ptr<FrameData> data;
+	};
+
+	std::mutex _mutex;
+	/// most recently used frame first
+	std::vector<Entry> _entries;
+
+	std::atomic<uint64_t> _hits;
+	std::atomic<uint64_t> _misses;
+};
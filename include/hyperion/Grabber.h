@@ -58,6 +58,11 @@ public:
 	///
 	virtual void setPixelDecimation(int pixelDecimation) {}
 
+	///
+	/// @brief Average the pixels of a decimation block instead of sampling one pixel (used from v4l)
+	///
+	virtual void setAverageDecimation(bool enable);
+
 	///
 	/// @brief Apply new signalThreshold (used from v4l)
 	///
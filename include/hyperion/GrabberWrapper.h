@@ -10,18 +10,17 @@
 #include <utils/Logger.h>
 #include <utils/Components.h>
 #include <utils/Image.h>
+#include <utils/FrameTiming.h>
+#include <utils/Tracer.h>
 #include <utils/ColorRgb.h>
 #include <utils/VideoMode.h>
 #include <utils/settings.h>
+#include <utils/CaptureRateController.h>
 
 class Grabber;
 class GlobalSignals;
 class QTimer;
 
-/// List of Hyperion instances that requested screen capt
-static QList<int> GRABBER_SYS_CLIENTS;
-static QList<int> GRABBER_V4L_CLIENTS;
-
 ///
 /// This class will be inherted by FramebufferWrapper and others which contains the real capture interface
 ///
@@ -29,10 +28,15 @@ class GrabberWrapper : public QObject
 {
 	Q_OBJECT
 public:
-	GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz = 0);
+	///
+	/// @param registerInstance  Register the wrapper as GrabberWrapper::instance. The additional V4L2 devices don't
+	///                          register, the instance of the primary V4L2 device enumerates the devices for the API
+	///
+	GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz = 0, bool registerInstance = true);
 
 	~GrabberWrapper() override;
 
+	/// the wrapper created last with registerInstance
 	static GrabberWrapper* instance;
 	static GrabberWrapper* getInstance(){ return instance; }
 
@@ -96,6 +100,7 @@ public:
 	template <typename Grabber_T>
 	bool transferFrame(Grabber_T &grabber)
 	{
+		TRACE_SCOPE("grab");
 		unsigned w = grabber.getImageWidth();
 		unsigned h = grabber.getImageHeight();
 		if ( _image.width() != w || _image.height() != h)
@@ -103,10 +108,13 @@ public:
 			_image.resize(w, h);
 		}
 
+		const int64_t captureTime = FrameTiming::now();
 		int ret = grabber.grabFrame(_image);
 		if (ret >= 0)
 		{
+			_image.setCaptureInfo(captureTime, FrameTiming::nextSequence());
 			emit systemImage(_grabberName, _image);
+			adaptRate(_image, captureTime);
 			return true;
 		}
 		return false;
@@ -133,6 +141,12 @@ public slots:
 	///
 	virtual void setCropping(unsigned cropLeft, unsigned cropRight, unsigned cropTop, unsigned cropBottom);
 
+	///
+	/// @brief Lower the grab rate while the picture is static
+	/// @param enable  True to adapt the rate, false to grab at the configured rate
+	///
+	virtual void setAdaptiveRate(bool enable);
+
 	///
 	/// @brief Handle settings update from HyperionDaemon Settingsmanager emit
 	/// @param type   settingyType from enum
@@ -149,7 +163,7 @@ signals:
 private slots:
 	/// @brief Handle a source request event from Hyperion.
 	/// Will start and stop grabber based on active listeners count
-	void handleSourceRequest(hyperion::Components component, int hyperionInd, bool listen);
+	void handleSourceRequest(hyperion::Components component, int hyperionInd, bool listen, const QString& device);
 
 	///
 	/// @brief Update Update capture rate
@@ -157,6 +171,27 @@ private slots:
 	///
 	void updateTimer(int interval);
 
+protected:
+	///
+	/// @brief Rename the grabber, a v4l grabber is requested by the instances with its name.
+	///        Starts or stops the grabber according to the listeners of the new name.
+	/// @param grabberName  The new name
+	///
+	void setGrabberName(const QString& grabberName);
+
+private:
+	///
+	/// @brief Check if a Hyperion instance listens to this grabber
+	///
+	bool hasListeners() const;
+
+	///
+	/// @brief Adapt the grab rate to the picture, a static picture is grabbed less often
+	/// @param image        The grabbed image
+	/// @param captureTime  The capture time of the image
+	///
+	void adaptRate(const Image<ColorRgb>& image, int64_t captureTime);
+
 protected:
 	QString _grabberName;
 
@@ -166,6 +201,10 @@ protected:
 	/// The calced update rate [ms]
 	int _updateInterval_ms;
 
+	/// Lowers the update rate while the picture is static
+	CaptureRateController _rateController;
+	bool _adaptiveRate;
+
 	/// The Logger instance
 	Logger * _log;
 
@@ -1,7 +1,9 @@
 #pragma once
 
 // stl includes
+#include <atomic>
 #include <list>
+#include <mutex>
 
 // QT includes
 #include <QString>
@@ -23,6 +25,7 @@
 #include <hyperion/PriorityMuxer.h>
 #include <hyperion/ColorAdjustment.h>
 #include <hyperion/ComponentRegister.h>
+#include <hyperion/LatencyTracker.h>
 
 // Effect engine includes
 #include <effectengine/EffectDefinition.h>
@@ -47,6 +50,7 @@ class BGEffectHandler;
 class CaptureCont;
 class BoblightServer;
 class LedDeviceWrapper;
+class FrameMailbox;
 class Logger;
 
 ///
@@ -111,6 +115,27 @@ public slots:
 	///
 	unsigned getLedCount() const;
 
+	///
+	/// @brief Get the number of images which were not processed as they are identical to the last processed image
+	///
+	quint64 getSkippedFrames() const { return _skippedFrames.load(std::memory_order_relaxed); }
+
+	///
+	/// @brief Get the frame latency statistic from capture to LED-Device write, per stage
+	/// @return Json object with a latency histogram per stage
+	///
+	QJsonObject getLatencyStats() const { return _latencyTracker.toJson(); }
+
+	///
+	/// @brief Reset the frame latency statistic
+	///
+	void resetLatencyStats() { _latencyTracker.reset(); }
+
+	///
+	/// @brief Get the number of input images which were replaced by a newer image of the same input before they have been processed
+	///
+	quint64 getCoalescedFrames();
+
 	///
 	/// @brief  Register a new input by priority, the priority is not active (timeout -100 isn't muxer recognized) until you start to update the data with setInput()
 	/// 		A repeated call to update the base data of a known priority won't overwrite their current timeout
@@ -531,9 +556,33 @@ private:
 	/// Capture control for Daemon native capture
 	CaptureCont* _captureCont;
 
-	/// buffer for leds (with adjustment)
+	/// buffer for leds (with adjustment), reserved for the hardware led count
 	std::vector<ColorRgb> _ledBuffer;
 
+	/// fingerprint of the last image processed by setInputImage(), valid until the next update()
+	bool _lastFrameValid;
+	int _lastFramePriority;
+	uint64_t _lastFrameHash;
+
+	/// number of images skipped by setInputImage() as unchanged, read by the API threads
+	std::atomic<quint64> _skippedFrames;
+
+	/// frame latency statistic from capture to LED-Device write
+	LatencyTracker _latencyTracker;
+
+	///
+	/// @brief Get the mailbox of a global input priority, created on first use
+	/// @param  priority  The priority
+	/// @return The mailbox
+	///
+	FrameMailbox* globalMailbox(int priority);
+
+	/// latest image per global input priority, posted by the server threads
+	std::mutex _globalMailboxMutex;
+	QMap<int, FrameMailbox*> _globalMailboxes;
+	/// set by freeObjects(), a server thread which was already posting must not create a new mailbox
+	bool _globalMailboxesClosed = false;
+
 	VideoMode _currVideoMode = VideoMode::VIDEO_2D;
 
 	/// Boblight instance
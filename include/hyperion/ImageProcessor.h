@@ -1,9 +1,11 @@
 #pragma once
 
 #include <QString>
+#include <QList>
 
 // Utils includes
 #include <utils/Image.h>
+#include <utils/Tracer.h>
 
 // Hyperion includes
 #include <hyperion/LedString.h>
@@ -56,6 +58,23 @@ public:
 	/// Returns starte of black border detector
 	bool blackBorderDetectorEnabled() const;
 
+	///
+	/// @brief Check if processing the last image again would result in the same led colors,
+	///        which is the case when the black border detection and the led mapping have settled
+	/// @return True if settled
+	///
+	bool isSettled() const;
+
+	///
+	/// @brief Publish the image areas which are read by the led layout (CaptureRegion), a grabber converts only these
+	///        areas. Image streaming, the black border detection and the unicolor mapping require the full image.
+	///        The black border detection is enabled by default, so the areas only take effect once it's disabled:
+	///        the led areas move inwards with a detected border and the detection scans whole lines of the image.
+	///        Returns early if nothing changed, so it's called per update.
+	/// @param fullImage  True if a consumer of the images of this instance requires the full image
+	///
+	void updateCaptureRegion(bool fullImage);
+
 	/// Returns the current _userMappingType, this may not be the current applied type!
 	int getUserLedMappingType() const { return _userMappingType; }
 
@@ -121,6 +140,7 @@ public:
 			switch (_mappingType)
 			{
 				case 1: colors = _imageToLeds->getUniLedColor(image); break;
+				case 2: colors.resize(_ledString.leds().size()); _imageToLeds->getMeanLedColorIntegral(image, _integralImage, colors); break;
 				default: colors = _imageToLeds->getMeanLedColor(image);
 			}
 		}
@@ -148,12 +168,17 @@ public:
 			setSize(image);
 
 			// Check black border detection
-			verifyBorder(image);
+			{
+				TRACE_SCOPE("blackborder");
+				verifyBorder(image);
+			}
 
 			// Determine the mean or uni colors of each led (using the existing mapping)
+			TRACE_SCOPE("map");
 			switch (_mappingType)
 			{
 				case 1: _imageToLeds->getUniLedColor(image, ledColors); break;
+				case 2: _imageToLeds->getMeanLedColorIntegral(image, _integralImage, ledColors); break;
 				default: _imageToLeds->getMeanLedColor(image, ledColors);
 			}
 		}
@@ -187,26 +212,22 @@ private:
 		{
 			Debug(_log, "Reset border");
 			_borderProcessor->process(image);
-			delete _imageToLeds;
-			_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+			_imageToLeds = getImageToLedsMap(image.width(), image.height(), 0, 0);
 		}
 
 		if(_borderProcessor->enabled() && _borderProcessor->process(image))
 		{
 			const hyperion::BlackBorder border = _borderProcessor->getCurrentBorder();
 
-			// Clean up the old mapping
-			delete _imageToLeds;
-
 			if (border.unknown)
 			{
-				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), 0, 0, _ledString.leds());
+				// Switch to the mapping without border
+				_imageToLeds = getImageToLedsMap(image.width(), image.height(), 0, 0);
 			}
 			else
 			{
-				// Construct a new buffer and mapping
-				_imageToLeds = new hyperion::ImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize, _ledString.leds());
+				// Switch to the mapping of the detected border
+				_imageToLeds = getImageToLedsMap(image.width(), image.height(), border.horizontalSize, border.verticalSize);
 			}
 
 			//Debug(Logger::getInstance("BLACKBORDER"),  "CURRENT BORDER TYPE: unknown=%d hor.size=%d vert.size=%d",
@@ -214,6 +235,30 @@ private:
 		}
 	}
 
+	///
+	/// Get the mapping for the given image size and border from the cache of recently used
+	/// mappings, the mapping is constructed when it is not cached yet. Black borders often flap
+	/// between a few sizes (e.g. letterboxed content), this avoids rebuilding the mapping each time.
+	///
+	/// @param[in] width            The width of the image
+	/// @param[in] height           The height of the image
+	/// @param[in] horizontalBorder The size of the horizontal border
+	/// @param[in] verticalBorder   The size of the vertical border
+	///
+	/// @return The mapping, owned by the cache
+	///
+	hyperion::ImageToLedsMap* getImageToLedsMap(unsigned width, unsigned height, unsigned horizontalBorder, unsigned verticalBorder);
+
+	///
+	/// Remove all cached mappings
+	///
+	void clearImageToLedsMaps();
+
+	///
+	/// Free the summed-area table unless the integral mapping is selected
+	///
+	void releaseIntegralImage();
+
 private slots:
 	void handleSettingsUpdate(settings::type type, const QJsonDocument& config);
 
@@ -228,6 +273,15 @@ private:
 	/// The mapping of image-pixels to leds
 	hyperion::ImageToLedsMap* _imageToLeds;
 
+	/// Recently used mappings of the current led layout, most recently used first
+	QList<hyperion::ImageToLedsMap*> _imageToLedsCache;
+
+	/// Number of mappings kept in _imageToLedsCache
+	static const int IMAGE_TO_LEDS_CACHE_SIZE = 4;
+
+	/// Summed-area table of the current image for the integral mapping, shared by the cached mappings
+	std::vector<uint32_t> _integralImage;
+
 	/// Type of image 2 led mapping
 	int _mappingType;
 	/// Type of last requested user type
@@ -235,6 +289,13 @@ private:
 	/// Type of last requested hard type
 	int _hardMappingType;
 
+	/// The capture region was published for the current led layout
+	bool _captureRegionValid;
+	/// The published capture region is the full image
+	bool _captureFullImage;
+	/// The full image was requested with the last updateCaptureRegion()
+	bool _fullImageRequested;
+
 	/// Hyperion instance pointer
 	Hyperion* _hyperion;
 };
@@ -3,11 +3,14 @@
 
 // STL includes
 #include <cassert>
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 
 // hyperion-utils includes
 #include <utils/Image.h>
 #include <utils/Logger.h>
+#include <utils/WorkerPool.h>
 
 // hyperion includes
 #include <hyperion/LedString.h>
@@ -16,7 +19,7 @@ namespace hyperion
 {
 
 	///
-	/// The ImageToLedsMap holds a mapping of indices into an image to leds. It can be used to
+	/// The ImageToLedsMap holds a mapping of image areas to leds. It can be used to
 	/// calculate the average (or mean) color per led for a specific region.
 	///
 	class ImageToLedsMap
@@ -24,9 +27,9 @@ namespace hyperion
 	public:
 
 		///
-		/// Constructs an mapping from the absolute indices in an image to each led based on the border
-		/// definition given in the list of leds. The map holds absolute indices to any given image,
-		/// provided that it is row-oriented.
+		/// Constructs an mapping from the areas in an image to each led based on the border
+		/// definition given in the list of leds. The map holds a run-length encoded area per led
+		/// which is valid for any given image, provided that it is row-oriented.
 		/// The mapping is created purely on size (width and height). The given borders are excluded
 		/// from indexing.
 		///
@@ -94,12 +97,48 @@ namespace hyperion
 				return;
 			}
 
-			// Iterate each led and compute the mean
+			// Small layouts are not worth the dispatch to the worker pool
+			if (_totalPixelCount < PARALLEL_PIXEL_THRESHOLD)
+			{
+				calcMeanColors(image, ledColors, 0, _colorsMap.size());
+				return;
+			}
+
+			WorkerPool::getInstance()->parallelFor(_colorsMap.size(), PARALLEL_MIN_LEDS,
+				[this, &image, &ledColors](size_t begin, size_t end)
+				{
+					calcMeanColors(image, ledColors, begin, end);
+				});
+		}
+
+		///
+		/// Determines the mean color for each led using a summed-area table of the image. The table is
+		/// built in a single pass over the image, after which the mean of every led is resolved with four
+		/// lookups, independent of the size of its area. This is preferable over getMeanLedColor() for
+		/// layouts with many leds or large (overlapping) areas.
+		///
+		/// @param[in] image  The image from which to extract the led colors
+		/// @param[in,out] integral  Buffer for the summed-area table of the image, owned by the caller so the
+		///                          mappings of several image sizes share one table
+		/// @param[out] ledColors  The vector containing the output
+		///
+		template <typename Pixel_T>
+		void getMeanLedColorIntegral(const Image<Pixel_T> & image, std::vector<uint32_t> & integral, std::vector<ColorRgb> & ledColors) const
+		{
+			// Sanity check for the number of leds
+			if(_colorsMap.size() != ledColors.size())
+			{
+				Debug(Logger::getInstance("HYPERION"), "ImageToLedsMap: colorsMap.size != ledColors.size -> %d != %d", _colorsMap.size(), ledColors.size());
+				return;
+			}
+
+			buildIntegralImage(image, integral);
+
+			// Iterate each led and resolve the mean from the corners of its area
 			auto led = ledColors.begin();
-			for (auto colors = _colorsMap.begin(); colors != _colorsMap.end(); ++colors, ++led)
+			for (auto span = _colorsMap.begin(); span != _colorsMap.end(); ++span, ++led)
 			{
-				const ColorRgb color = calcMeanColor(image, *colors);
-				*led = color;
+				*led = calcIntegralMeanColor(integral, *span);
 			}
 		}
 
@@ -144,6 +183,22 @@ namespace hyperion
 		}
 
 	private:
+		///
+		/// The image area of a single led. As every led integrates a rectangle of the image, the area
+		/// is stored run-length encoded: a run of 'length' pixels starting at column 'xStart' which is
+		/// repeated for every row in [yStart, yEnd).
+		///
+		struct LedSpan
+		{
+			unsigned xStart;
+			unsigned length;
+			unsigned yStart;
+			unsigned yEnd;
+
+			/// @return The number of pixels covered by this span (zero for leds without area)
+			unsigned pixelCount() const { return length * (yEnd - yStart); }
+		};
+
 		/// The width of the indexed image
 		const unsigned _width;
 		/// The height of the indexed image
@@ -153,46 +208,152 @@ namespace hyperion
 
 		const unsigned _verticalBorder;
 
-		/// The absolute indices into the image for each led
-		std::vector<std::vector<unsigned>> _colorsMap;
+		/// The run-length encoded image area for each led
+		std::vector<LedSpan> _colorsMap;
+
+		/// The sum of the areas of all leds
+		size_t _totalPixelCount;
+
+		/// Total led area [pixels] from which on the mean colors are computed by the worker pool
+		static const size_t PARALLEL_PIXEL_THRESHOLD = 1 << 16;
+		/// Minimum number of leds handled by a single worker
+		static const size_t PARALLEL_MIN_LEDS = 16;
+
+		///
+		/// Determines the mean color for the leds [begin, end)
+		///
+		/// @param[in] image  The image from which to extract the led colors
+		/// @param[out] ledColors  The vector containing the output
+		/// @param[in] begin, end  The range of leds to process
+		///
+		template <typename Pixel_T>
+		void calcMeanColors(const Image<Pixel_T> & image, std::vector<ColorRgb> & ledColors, size_t begin, size_t end) const
+		{
+			for (size_t idx = begin; idx < end; ++idx)
+			{
+				ledColors[idx] = calcMeanColor(image, _colorsMap[idx]);
+			}
+		}
+
+		///
+		/// Fills the summed-area table with the given image, interleaved RGB with a leading row and column
+		/// of zeros ((width+1) x (height+1) x 3 entries). The sums are stored as 32-bit values which
+		/// may wrap around for large images; as unsigned arithmetic is modular the difference of the four
+		/// corners stays exact for every area smaller than 2^32/255 pixels (~16.8 megapixels).
+		///
+		/// @param[in] image The image to integrate
+		/// @param[out] integral The summed-area table
+		///
+		template <typename Pixel_T>
+		static void buildIntegralImage(const Image<Pixel_T> & image, std::vector<uint32_t> & integral)
+		{
+			const unsigned imgWidth  = image.width();
+			const unsigned imgHeight = image.height();
+			const size_t stride = size_t(imgWidth + 1) * 3;
+
+			integral.resize(stride * (imgHeight + 1));
+			std::fill(integral.begin(), integral.begin() + stride, 0);
+
+			const Pixel_T * imgData = image.memptr();
+			for (unsigned y = 0; y < imgHeight; ++y)
+			{
+				const Pixel_T * row = imgData + size_t(y) * imgWidth;
+				const uint32_t * above = integral.data() + size_t(y) * stride;
+				uint32_t * current = integral.data() + size_t(y + 1) * stride;
+
+				current[0] = current[1] = current[2] = 0;
+
+				uint32_t rowRed   = 0;
+				uint32_t rowGreen = 0;
+				uint32_t rowBlue  = 0;
+				for (unsigned x = 0; x < imgWidth; ++x)
+				{
+					rowRed   += row[x].red;
+					rowGreen += row[x].green;
+					rowBlue  += row[x].blue;
+
+					const size_t idx = size_t(x + 1) * 3;
+					current[idx]     = above[idx]     + rowRed;
+					current[idx + 1] = above[idx + 1] + rowGreen;
+					current[idx + 2] = above[idx + 2] + rowBlue;
+				}
+			}
+		}
+
+		///
+		/// Calculates the 'mean color' of the given span from the summed-area table
+		///
+		/// @param[in] integral  The summed-area table of the image
+		/// @param[in] span  The image area of the led
+		///
+		/// @return The mean of the given span (or black when empty)
+		///
+		ColorRgb calcIntegralMeanColor(const std::vector<uint32_t> & integral, const LedSpan & span) const;
 
 		///
-		/// Calculates the 'mean color' of the given list. This is the mean over each color-channel
+		/// Accumulates the color channels of a single row of pixels
+		///
+		/// @param[in] row     Pointer to the first pixel of the row
+		/// @param[in] length  The number of pixels to accumulate
+		/// @param[in,out] red, green, blue  The channel sums the row is added to
+		///
+		template <typename Pixel_T>
+		static void accumulateRow(const Pixel_T * row, unsigned length, uint64_t & red, uint64_t & green, uint64_t & blue)
+		{
+			uint32_t rowRed   = 0;
+			uint32_t rowGreen = 0;
+			uint32_t rowBlue  = 0;
+			for (unsigned idx = 0; idx < length; ++idx)
+			{
+				rowRed   += row[idx].red;
+				rowGreen += row[idx].green;
+				rowBlue  += row[idx].blue;
+			}
+			red   += rowRed;
+			green += rowGreen;
+			blue  += rowBlue;
+		}
+
+		///
+		/// Vectorized (SSE2/NEON, scalar fallback) variant of accumulateRow() for packed RGB pixels
+		///
+		static void accumulateRow(const ColorRgb * row, unsigned length, uint64_t & red, uint64_t & green, uint64_t & blue);
+
+		///
+		/// Calculates the 'mean color' of the given span. This is the mean over each color-channel
 		/// (red, green, blue)
 		///
 		/// @param[in] image The image a section from which an average color must be computed
-		/// @param[in] colors  The list with colors
+		/// @param[in] span  The image area of the led
 		///
-		/// @return The mean of the given list of colors (or black when empty)
+		/// @return The mean of the given span (or black when empty)
 		///
 		template <typename Pixel_T>
-		ColorRgb calcMeanColor(const Image<Pixel_T> & image, const std::vector<unsigned> & colors) const
+		ColorRgb calcMeanColor(const Image<Pixel_T> & image, const LedSpan & span) const
 		{
-			const auto colorVecSize = colors.size();
+			const unsigned pixelCount = span.pixelCount();
 
-			if (colorVecSize == 0)
+			if (pixelCount == 0)
 			{
 				return ColorRgb::BLACK;
 			}
 
 			// Accumulate the sum of each seperate color channel
-			uint_fast32_t cummRed   = 0;
-			uint_fast32_t cummGreen = 0;
-			uint_fast32_t cummBlue  = 0;
-			const auto& imgData = image.memptr();
+			uint64_t cummRed   = 0;
+			uint64_t cummGreen = 0;
+			uint64_t cummBlue  = 0;
+			const Pixel_T * imgData = image.memptr();
+			const unsigned imgWidth = image.width();
 
-			for (const unsigned colorOffset : colors)
+			for (unsigned y = span.yStart; y < span.yEnd; ++y)
 			{
-				const auto& pixel = imgData[colorOffset];
-				cummRed   += pixel.red;
-				cummGreen += pixel.green;
-				cummBlue  += pixel.blue;
+				accumulateRow(imgData + y * imgWidth + span.xStart, span.length, cummRed, cummGreen, cummBlue);
 			}
 
 			// Compute the average of each color channel
-			const uint8_t avgRed   = uint8_t(cummRed/colorVecSize);
-			const uint8_t avgGreen = uint8_t(cummGreen/colorVecSize);
-			const uint8_t avgBlue  = uint8_t(cummBlue/colorVecSize);
+			const uint8_t avgRed   = uint8_t(cummRed/pixelCount);
+			const uint8_t avgGreen = uint8_t(cummGreen/pixelCount);
+			const uint8_t avgBlue  = uint8_t(cummBlue/pixelCount);
 
 			// Return the computed color
 			return {avgRed, avgGreen, avgBlue};
@@ -210,19 +371,18 @@ namespace hyperion
 		ColorRgb calcMeanColor(const Image<Pixel_T> & image) const
 		{
 			// Accumulate the sum of each seperate color channel
-			uint_fast32_t cummRed   = 0;
-			uint_fast32_t cummGreen = 0;
-			uint_fast32_t cummBlue  = 0;
-			const unsigned imageSize = image.width() * image.height();
+			uint64_t cummRed   = 0;
+			uint64_t cummGreen = 0;
+			uint64_t cummBlue  = 0;
+			const unsigned imgWidth  = image.width();
+			const unsigned imgHeight = image.height();
+			const unsigned imageSize = imgWidth * imgHeight;
 
-			const auto& imgData = image.memptr();
+			const Pixel_T * imgData = image.memptr();
 
-			for (unsigned idx=0; idx<imageSize; idx++)
+			for (unsigned y = 0; y < imgHeight; ++y)
 			{
-				const auto& pixel = imgData[idx];
-				cummRed   += pixel.red;
-				cummGreen += pixel.green;
-				cummBlue  += pixel.blue;
+				accumulateRow(imgData + y * imgWidth, imgWidth, cummRed, cummGreen, cummBlue);
 			}
 
 			// Compute the average of each color channel
@@ -0,0 +1,102 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+// QT includes
+#include <QMutex>
+#include <QJsonObject>
+
+// util includes
+#include <utils/LatencyHistogram.h>
+
+///
+/// @brief Collects the latency of frames on their way from the capture point to the LED-Device write of an instance.
+/// Frames are identified by the capture time and sequence number stamped at their capture point (see FrameTiming).
+/// The stages are
+///   - capture:    capture point -> Hyperion::setInputImage()
+///   - processing: start of Hyperion::update() -> led colors handed to smoothing/LED-Device
+///   - output:     led colors handed over -> start of the LED-Device write (smoothing and queueing)
+///   - device:     duration of the LED-Device write
+///   - total:      capture point -> end of the LED-Device write
+/// All methods are thread safe.
+///
+class LatencyTracker
+{
+public:
+	LatencyTracker();
+
+	///
+	/// @brief Record the arrival of a frame at the instance
+	/// @param captureTime The capture time of the frame, 0 if unknown
+	/// @param inputTime   The arrival time
+	///
+	void frameReceived(int64_t captureTime, int64_t inputTime);
+
+	///
+	/// @brief Record that the led colors of a frame were handed to smoothing/LED-Device.
+	///        Repeated updates of the same frame are ignored, the first one is measured.
+	/// @param sequence     The sequence number of the frame, 0 if unknown
+	/// @param captureTime  The capture time of the frame, 0 if unknown
+	/// @param processStart The time the processing started
+	/// @param processEnd   The time the led colors were handed over
+	///
+	void frameProcessed(uint64_t sequence, int64_t captureTime, int64_t processStart, int64_t processEnd);
+
+	///
+	/// @brief Record a LED-Device write, completes the latency of the last processed frame
+	/// @param writeStart The time the write started
+	/// @param writeEnd   The time the write returned
+	///
+	void ledsWritten(int64_t writeStart, int64_t writeEnd);
+
+	///
+	/// @brief Record the heap allocations of a Hyperion::update() including the hand-off to smoothing/LED-Device
+	/// @param allocations The number of allocations counted by AllocationCounter
+	///
+	void updateAllocations(uint64_t allocations);
+
+	///
+	/// @brief Get the histograms of all stages
+	/// @return Json object with one histogram per stage, the number of frames which were superseded before being written
+	///         and the allocations per update
+	///
+	QJsonObject toJson() const;
+
+	///
+	/// @brief Remove all samples
+	///
+	void reset();
+
+private:
+	enum Stage
+	{
+		STAGE_CAPTURE,
+		STAGE_PROCESSING,
+		STAGE_OUTPUT,
+		STAGE_DEVICE,
+		STAGE_TOTAL,
+		STAGE_COUNT
+	};
+
+	mutable QMutex _mutex;
+	LatencyHistogram _stages[STAGE_COUNT];
+
+	/// sequence number of the last processed frame
+	uint64_t _lastSequence;
+
+	/// a processed frame waits for its LED-Device write
+	bool _pending;
+	int64_t _pendingCaptureTime;
+	int64_t _pendingHandoverTime;
+
+	/// processed frames replaced by a newer one before a write happened
+	uint64_t _supersededFrames;
+
+	/// heap allocations of the updates
+	uint64_t _updates;
+	uint64_t _allocatingUpdates;
+	uint64_t _lastAllocations;
+	uint64_t _maxAllocations;
+	uint64_t _totalAllocations;
+};
@@ -8,6 +8,7 @@
 // Hyperion includes
 #include <utils/ColorRgb.h>
 #include <hyperion/ColorAdjustment.h>
+#include <hyperion/LedString.h>
 
 ///
 /// The LedColorTransform is responsible for performing color transformation from 'raw' colors
@@ -32,6 +33,12 @@ public:
 
 	void setBacklightEnabled(bool enable);
 
+	///
+	/// Notifies that one or more ColorAdjustment have been changed. The color lookup tables are
+	/// rebuilt with the next call of applyAdjustment().
+	///
+	void updateAdjustments();
+
 	///
 	/// Returns the identifier of all the unique ColorAdjustment
 	///
@@ -48,22 +55,91 @@ public:
 	ColorAdjustment* getAdjustment(const QString& id);
 
 	///
-	/// Performs the color adjustment from raw-color to led-color
+	/// Sets the color byte order of each led, which is applied by applyAdjustment() after the
+	/// color adjustment. Leds without a color order keep the rgb order.
+	///
+	/// @param ledColorOrder The color order for each individual led
+	///
+	void setLedColorOrder(const std::vector<ColorOrder>& ledColorOrder);
+
+	///
+	/// Performs the color adjustment from raw-color to led-color and reorders the color channels
+	/// to the byte order of each led, in a single pass over the leds
 	///
 	/// @param ledColors The list with raw colors
 	///
 	void applyAdjustment(std::vector<ColorRgb>& ledColors);
 
 private:
+	///
+	/// A range of consecutive leds sharing the same ColorAdjustment and color order
+	///
+	struct LedRange
+	{
+		/// First led of the range
+		size_t begin;
+		/// One past the last led of the range
+		size_t end;
+		/// The adjustment of the leds (nullptr for none)
+		ColorAdjustment* adjustment;
+		/// The color lookup table of the adjustment (nullptr for none)
+		const ColorRgb* lut;
+		/// Source channel (0=red, 1=green, 2=blue) of each output channel
+		uint8_t channelOrder[3];
+	};
+
+	///
+	/// Rebuilds _ledRanges from _ledAdjustments and _ledColorOrder
+	///
+	void updateLedRanges();
+
+	///
+	/// Rebuilds the color lookup table of each ColorAdjustment
+	///
+	void updateLuts();
+
+	///
+	/// Performs the color adjustment of a single (gamma corrected) color, without lookup table
+	///
+	/// @param adjustment The adjustment of the led
+	/// @param red, green, blue The gamma corrected color
+	///
+	/// @return The adjusted color
+	///
+	static ColorRgb adjustColor(ColorAdjustment* adjustment, uint8_t red, uint8_t green, uint8_t blue);
+
+	///
+	/// Performs the color adjustment of a single led using the lookup table of its adjustment
+	///
+	/// @param adjustment The adjustment of the led
+	/// @param lut        The lookup table of the adjustment
+	/// @param color      The raw color, replaced by the adjusted color
+	///
+	static void adjustColor(ColorAdjustment* adjustment, const ColorRgb* lut, ColorRgb& color);
+
+	/// Number of nodes per channel of the color lookup tables
+	static const int LUT_SIZE = 33;
+
 	/// List with transform ids
 	QStringList _adjustmentIds;
 
 	/// List with unique ColorTransforms
 	std::vector<ColorAdjustment*> _adjustment;
 
+	/// The color lookup table (LUT_SIZE^3 nodes) of each ColorAdjustment in _adjustment
+	std::vector<std::vector<ColorRgb>> _adjustmentLuts;
+	bool _adjustmentLutsValid;
+
 	/// List with a pointer to the ColorAdjustment for each individual led
 	std::vector<ColorAdjustment*> _ledAdjustments;
 
+	/// List with the color order for each individual led
+	std::vector<ColorOrder> _ledColorOrder;
+
+	/// The leds grouped by adjustment and color order, rebuilt on demand
+	std::vector<LedRange> _ledRanges;
+	bool _ledRangesValid;
+
 	// logger instance
 	Logger * _log;
 };
@@ -2,6 +2,7 @@
 
 // STL includes
 #include <vector>
+#include <utility>
 #include <cstdint>
 
 // QT includes
@@ -71,7 +72,7 @@ public:
 	~PriorityMuxer() override;
 
 	///
-	/// @brief Start/Stop the PriorityMuxer update timer; On disabled no priority and timeout updates will be performend
+	/// @brief Start/Stop the PriorityMuxer timeout handling; On disabled no timeout updates will be performend
 	/// @param  enable  The new state
 	///
 	void setEnable(bool enable);
@@ -129,9 +130,10 @@ public:
 	///
 	/// @param priority The priority channel
 	///
-	/// @return The information for the specified priority channel
+	/// @return The information for the specified priority channel, valid until the next change of the muxer.
+	///         Only the thread of the owning instance may hold the reference, other threads have to copy it.
 	///
-	InputInfo getInputInfo(int priority) const;
+	const InputInfo& getInputInfo(int priority) const;
 
 	///
 	/// @brief  Register a new input by priority, the priority is not active (timeout -100 isn't muxer recognized) until you start to update the data with setInput()
@@ -243,12 +245,32 @@ private slots:
 	void timeTrigger();
 
 	///
-	/// Updates the current time. Channels with a configured time out will be checked and cleared if
-	/// required.
+	/// Updates the current time. Channels which reached their timeout are cleared and the visible
+	/// priority is re-evaluated. Called on input changes and when the next timeout is due.
 	///
 	void setCurrentTime();
 
 private:
+	///
+	/// @brief Find the input of a priority
+	/// @param priority  The priority
+	/// @return The input, nullptr if not found
+	///
+	InputInfo* findInput(int priority);
+	const InputInfo* findInput(int priority) const;
+
+	///
+	/// @brief Add a timeout to the timeout heap and reschedule the update timer if it's due earlier
+	/// @param timeoutTime_ms  The absolute timeout
+	/// @param priority        The priority
+	///
+	void addTimeout(int64_t timeoutTime_ms, int priority);
+
+	///
+	/// @brief Start the update timer for the next due timeout
+	///
+	void scheduleUpdate();
+
 	///
 	/// @brief Get the component of the given priority
 	/// @return The component
@@ -267,8 +289,12 @@ private:
 	// The last visible component
 	hyperion::Components _prevVisComp = hyperion::COMP_INVALID;
 
-	/// The mapping from priority channel to led-information
-	QMap<int, InputInfo> _activeInputs;
+	/// The priority channels sorted by priority
+	std::vector<InputInfo> _activeInputs;
+
+	/// Min-heap of absolute timeouts and their priority. An entry may be outdated (input cleared or timeout
+	/// extended), this is checked when the entry is due
+	std::vector<std::pair<int64_t, int>> _timeoutHeap;
 
 	/// The information of the lowest priority channel
 	InputInfo _lowestPriorityInfo;
@@ -276,8 +302,14 @@ private:
 	// Reflect the state of auto select
 	bool _sourceAutoSelectEnabled;
 
-	// Timer to update Muxer times independent
+	// Single shot timer for the next due timeout
 	QTimer* _updateTimer;
+	// Absolute time the update timer is scheduled for
+	int64_t _nextUpdate_ms;
+	// True while an effect or color with timeout is running, requires updates for timeRunner()
+	bool _timeRunning;
+	// State of setEnable()
+	bool _enabled;
 
 	QTimer* _timer;
 	QTimer* _blockTimer;
@@ -222,6 +222,14 @@ signals:
 	///
 	void enableStateChanged(bool newState);
 
+	///
+	/// @brief Emits after the LED-Device wrote LED values, used for the frame latency statistic
+	///
+	/// @param[in] writeStart The monotonic time (see FrameTiming::now()) in microseconds the write started
+	/// @param[in] writeEnd   The monotonic time in microseconds the write returned
+	///
+	void ledsWritten(qint64 writeStart, qint64 writeEnd);
+
 protected:
 
 	///
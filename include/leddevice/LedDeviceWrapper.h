@@ -10,12 +10,15 @@
 
 class LedDevice;
 class Hyperion;
+class QAbstractEventDispatcher;
 
 typedef LedDevice* ( *LedDeviceCreateFuncType ) ( const QJsonObject& );
 typedef std::map<QString,LedDeviceCreateFuncType> LedDeviceRegistry;
 
 ///
 /// @brief Creates and destroys LedDevice instances with LedDeviceFactory and moves the device to a thread. Pipes all signal/slots and methods to LedDevice instance
+/// The led values are handed to the device thread with two preallocated buffers which alternate, the device always writes the latest values.
+/// The device thread is woken up through its event dispatcher, no event is posted per frame.
 ///
 class LedDeviceWrapper : public QObject
 {
@@ -80,19 +83,27 @@ public slots:
 	///
 	void handleComponentState(hyperion::Components component, bool state);
 
-signals:
 	///
-	/// PIPER signal for Hyperion -> LedDevice
+	/// @brief Hand the led values to the LedDevice. They are copied into the buffer the device does not read,
+	///        values which were not written yet are replaced, and the device thread is woken up.
+	///        No memory is allocated as long as the led count is unchanged.
 	///
 	/// @param[in] ledValues  The RGB-color per led
 	///
-	/// @return Zero on success else negative
-	///
-	int updateLeds(const std::vector<ColorRgb>& ledValues);
+	void updateLeds(const std::vector<ColorRgb>& ledValues);
 
+signals:
 	void setEnable(bool enable);
 	void closeLedDevice();
 
+	///
+	/// PIPER signal for LedDevice -> Hyperion, emits after the LedDevice wrote LED values
+	///
+	/// @param[in] writeStart The monotonic time in microseconds the write started
+	/// @param[in] writeEnd   The monotonic time in microseconds the write returned
+	///
+	void ledsWritten(qint64 writeStart, qint64 writeEnd);
+
 private slots:
 	///
 	/// @brief Is called whenever the led device switches between on/off. The led device can disable it's component state
@@ -113,6 +124,11 @@ private:
 	///
 	void stopDeviceThread();
 
+	///
+	/// @brief Write the latest led values to the LedDevice, runs in the device thread whenever its event loop wakes up or is about to block
+	///
+	void writePendingLeds();
+
 private:
 	// parent Hyperion
 	Hyperion* _hyperion;
@@ -120,6 +136,21 @@ private:
 	LedDevice* _ledDevice;
 	// the enable state
 	bool _enabled;
+
+	/// guards the buffer indices, the pending flag and the dispatcher
+	QMutex _ledBufferMutex;
+	/// event dispatcher of the device thread, nullptr while the thread is not running
+	QAbstractEventDispatcher* _deviceDispatcher;
+	/// a write is in progress, the device may run a nested event loop (device thread only)
+	bool _writingLeds;
+	/// the alternating led buffers
+	std::vector<ColorRgb> _ledBuffers[2];
+	/// buffer with the latest led values
+	int _latestBuffer;
+	/// buffer the device is writing, -1 if none
+	int _readingBuffer;
+	/// the latest led values were not taken by the device yet
+	bool _ledsPending;
 };
 
 #endif // LEDEVICEWRAPPER_H
@@ -0,0 +1,24 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+///
+/// @brief Counts the heap allocations per thread.
+/// Only compiled with ENABLE_ALLOCATION_COUNTER (default in debug builds). With glibc malloc, calloc and realloc are replaced,
+/// which counts the allocations of the shared libraries (Qt containers, libstdc++) as well. Other C libraries count the global operator new only.
+///
+namespace AllocationCounter {
+
+	///
+	/// @brief Check if the allocations are counted
+	/// @return               True if compiled with ENABLE_ALLOCATION_COUNTER
+	///
+	bool enabled();
+
+	///
+	/// @brief Get the number of allocations of the calling thread since its start
+	/// @return               The allocation count, always 0 if not enabled
+	///
+	uint64_t threadAllocations();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// util includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+///
+/// Adapts the rate at which a grabber captures and processes frames to the content. The interval between
+/// frames is doubled step by step while the picture is static and set to the idle interval at once while
+/// there is no signal or the source is in standby. A changed picture restores the full rate instantly.
+/// Not thread safe, used by the thread which processes the frames.
+///
+class CaptureRateController
+{
+public:
+	CaptureRateController();
+
+	///
+	/// @brief Set the interval between frames at full rate and restore the full rate
+	/// @param interval  The interval in microseconds
+	///
+	void setFullInterval(int64_t interval);
+
+	///
+	/// @brief Restore the full rate and forget the previous picture, e.g. when the capture is started
+	///
+	void reset();
+
+	///
+	/// @brief Compare a processed image with the previous one and adapt the interval
+	/// @param image  The image
+	/// @param time   The capture time of the image in microseconds (FrameTiming)
+	/// @return True if the picture changed
+	///
+	bool update(const Image<ColorRgb>& image, int64_t time);
+
+	///
+	/// @brief Set the idle state (no signal, standby), the idle interval applies until it's left
+	/// @param idle  True if idle
+	///
+	void setIdle(bool idle);
+
+	///
+	/// @brief Get the interval until the next frame should be processed
+	/// @return The interval in microseconds
+	///
+	int64_t interval() const { return _interval; }
+
+	///
+	/// @brief Check if frames are processed at the full rate
+	///
+	bool isFullRate() const { return _interval <= _fullInterval; }
+
+	///
+	/// @brief Compare one channel (luma) of a raw frame with the samples of the previous frame. It's cheap enough to
+	/// check the frames which are dropped at a lowered rate, independent of a controller.
+	/// @param data         The first sampled byte of the frame
+	/// @param width        The width of the frame
+	/// @param height       The height of the frame
+	/// @param lineLength   The bytes per line
+	/// @param pixelStride  The bytes per pixel of the sampled channel
+	/// @param samples      The samples of the previous frame, updated. Without samples the frame is not changed
+	/// @return True if the picture changed beyond the noise of a capture
+	///
+	static bool lumaChanged(const uint8_t* data, unsigned width, unsigned height, unsigned lineLength, unsigned pixelStride, std::vector<uint8_t>& samples);
+
+private:
+	///
+	/// @brief Sample the image and compare the samples with the ones of the previous image
+	/// @return True if the picture changed beyond the noise of a capture
+	///
+	bool sampleChanged(const Image<ColorRgb>& image);
+
+	/// the interval between frames at full rate
+	int64_t _fullInterval;
+	/// the current interval
+	int64_t _interval;
+	/// capture time of the first frame of the current static picture
+	int64_t _staticSince;
+	bool _idle;
+
+	/// samples of the previous image
+	std::vector<ColorRgb> _samples;
+	unsigned _sampledWidth;
+	unsigned _sampledHeight;
+};
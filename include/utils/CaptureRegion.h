@@ -0,0 +1,79 @@
+#pragma once
+
+// stl
+#include <atomic>
+
+// qt
+#include <QMap>
+#include <QMutex>
+#include <QRectF>
+#include <QVector>
+
+///
+/// Singleton registry of the image areas the consumers of a capture read, shared by all hyperion instances.
+/// Each consumer (the image processor of an instance) sets the areas of its led layout in relative
+/// coordinates (0..1) or requests the full image (image streaming, black border detection, unicolor mapping).
+/// A grabber may convert only the union of the areas and leave the remaining pixels of the image black.
+///
+/// The led colors are still computed from the converted image and not from the raw frame: every instance maps
+/// the frame with its own layout, border and mapping type in its own thread, after the mailbox and the
+/// PriorityMuxer, which keep the last image to update the leds again (timeouts, smoothing, source switches).
+/// Holding the raw driver buffer that long would starve the capture queue.
+///
+class CaptureRegion
+{
+public:
+	static CaptureRegion* getInstance()
+	{
+		static CaptureRegion instance;
+		return & instance;
+	}
+
+	CaptureRegion(CaptureRegion const&) = delete;
+	void operator=(CaptureRegion const&) = delete;
+
+	///
+	/// @brief Set the areas which are read by a consumer
+	/// @param owner      The consumer
+	/// @param rects      The led areas in relative coordinates
+	/// @param fullImage  True if the consumer reads the full image
+	///
+	void setRegion(const void* owner, const QVector<QRectF>& rects, bool fullImage);
+
+	///
+	/// @brief Remove the areas of a consumer
+	/// @param owner  The consumer
+	///
+	void removeRegion(const void* owner);
+
+	///
+	/// @brief Get the union of the areas of all consumers
+	/// @return The areas, empty if the full image is required or if there are no consumers
+	///
+	QVector<QRectF> getRegion() const;
+
+	///
+	/// @brief Get the led areas of all consumers, including the consumers of the full image.
+	///        Used to estimate the capture resolution which is required by the led layouts.
+	/// @return The areas, empty if no consumer is known yet
+	///
+	QVector<QRectF> getLedAreas() const;
+
+	///
+	/// @brief Get the generation of the region, it's incremented with each change. Cheap to poll per frame.
+	///
+	unsigned generation() const { return _generation.load(std::memory_order_acquire); }
+
+private:
+	CaptureRegion();
+
+	mutable QMutex _mutex;
+	struct Region
+	{
+		QVector<QRectF> rects;
+		bool fullImage;
+	};
+
+	QMap<const void*, Region> _regions;
+	std::atomic<unsigned> _generation;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+// stl
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// qt
+#include <QObject>
+#include <QString>
+
+// util
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+
+///
+/// @brief Single slot mailbox between a frame producer and a consumer thread, the latest frame wins.
+/// post() and discard() are thread safe and hold the lock only to swap the frame. A frame which was not taken yet
+/// is replaced (coalesced), so a slow consumer processes the most recent frame instead of a growing backlog.
+/// frameAvailable() is emitted once when the empty slot is filled, connect it queued to the consumer
+/// which calls take() with the generation of the signal.
+///
+class FrameMailbox : public QObject
+{
+	Q_OBJECT
+public:
+	struct Frame
+	{
+		Image<ColorRgb> image;
+		/// name of the capture source (system/v4l capture)
+		QString source;
+		/// priority, timeout and effect handling of a global input
+		int priority;
+		int timeout_ms;
+		bool clearEffect;
+	};
+
+	explicit FrameMailbox(QObject* parent = nullptr);
+
+	///
+	/// @brief Put a frame into the mailbox, replaces a frame which was not taken yet
+	/// @param frame  The frame
+	///
+	void post(const Frame& frame);
+
+	///
+	/// @brief Take the frame out of the mailbox
+	/// @param[out] frame       The frame
+	/// @param      generation  The generation of the frameAvailable() signal
+	/// @return False if the mailbox is empty or the frame was discarded after the signal
+	///
+	bool take(Frame& frame, quint64 generation);
+
+	///
+	/// @brief Drop a frame which was not taken yet, e.g. when the input is cleared. A wake up which is still queued
+	/// is outdated, a frame posted afterwards is signalled again and taken after the queued clear.
+	///
+	void discard();
+
+	///
+	/// @brief Get the number of frames which were replaced by a newer frame before being taken
+	///
+	quint64 coalescedFrames() const { return _coalesced.load(std::memory_order_relaxed); }
+
+signals:
+	///
+	/// @brief Emits when a frame was posted into the empty mailbox
+	/// @param generation  Pass it to take()
+	///
+	void frameAvailable(quint64 generation);
+
+private:
+	std::mutex _mutex;
+	/// the latest frame, valid while _full
+	Frame _frame;
+	bool _full;
+	/// a frameAvailable() of the current generation is queued
+	bool _signalled;
+	/// increased by discard(), outdates queued signals
+	quint64 _generation;
+	std::atomic<quint64> _coalesced;
+};
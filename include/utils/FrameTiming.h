@@ -0,0 +1,32 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+// util includes
+#include <utils/Image.h>
+
+namespace FrameTiming {
+
+	///
+	/// @brief Get the current time of the monotonic clock used for frame latency measurements
+	/// @return               The time in microseconds
+	///
+	int64_t now();
+
+	///
+	/// @brief Get the next frame sequence number, unique over all capture points of the process
+	/// @return               The sequence number, never 0
+	///
+	uint64_t nextSequence();
+
+	///
+	/// @brief Stamp an image with the current time and a new sequence number at its capture point
+	/// @param[in,out] image  The captured image
+	///
+	template <typename Pixel_T>
+	void stamp(Image<Pixel_T>& image)
+	{
+		image.setCaptureInfo(now(), nextSequence());
+	}
+}
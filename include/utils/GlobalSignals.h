@@ -10,6 +10,7 @@
 
 ///
 /// Singleton instance for simple signal sharing across threads, should be never used with Qt:DirectConnection!
+/// Exception: image signals are connected direct to a thread safe FrameMailbox of the receiving instance
 ///
 class GlobalSignals : public QObject
 {
@@ -98,7 +99,8 @@ signals:
 	/// @param component  The component to handle
 	/// @param hyperionInd The Hyperion instance index as identifier
 	/// @param listen  True when listening, else false
+	/// @param device  The requested v4l device (path), empty for any device
 	///
-	void requestSource(hyperion::Components component, int hyperionInd, bool listen);
+	void requestSource(hyperion::Components component, int hyperionInd, bool listen, const QString& device = QString());
 
 };
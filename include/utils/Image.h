@@ -142,6 +142,15 @@ public:
 		_d_ptr->resize(width, height);
 	}
 
+	///
+	/// Check if the pixels are shared with a copy of the image. A write access to a shared image detaches (copies) it.
+	/// @return True if another image references the pixels
+	///
+	bool isShared() const
+	{
+		return _d_ptr.constData()->ref.loadAcquire() > 1;
+	}
+
 	///
 	/// Returns a memory pointer to the first pixel in the image
 	/// @return The memory pointer to the first pixel
@@ -170,6 +179,34 @@ public:
 		_d_ptr->toRgb(*image._d_ptr);
 	}
 
+	///
+	/// Returns the monotonic capture timestamp of the frame in microseconds
+	/// @return The capture time, 0 if the image was not stamped at a capture point
+	///
+	int64_t captureTime() const
+	{
+		return _d_ptr->captureTime();
+	}
+
+	///
+	/// Returns the sequence number assigned to the frame at capture
+	/// @return The sequence number, 0 if the image was not stamped at a capture point
+	///
+	uint64_t sequence() const
+	{
+		return _d_ptr->sequence();
+	}
+
+	///
+	/// Attach capture information to the frame
+	/// @param captureTime The monotonic capture timestamp in microseconds
+	/// @param sequence The frame sequence number
+	///
+	void setCaptureInfo(int64_t captureTime, uint64_t sequence)
+	{
+		_d_ptr->setCaptureInfo(captureTime, sequence);
+	}
+
 	///
 	/// Get size of buffer
 	///
@@ -27,7 +27,9 @@ public:
 	ImageData(unsigned width, unsigned height, const Pixel_T background) :
 		_width(width),
 		_height(height),
-		_pixels(new Pixel_T[width * height + 1])
+		_pixels(new Pixel_T[width * height + 1]),
+		_captureTime(0),
+		_sequence(0)
 	{
 		std::fill(_pixels, _pixels + width * height, background);
 	}
@@ -36,7 +38,9 @@ public:
 		QSharedData(other),
 		_width(other._width),
 		_height(other._height),
-		_pixels(new Pixel_T[other._width * other._height + 1])
+		_pixels(new Pixel_T[other._width * other._height + 1]),
+		_captureTime(other._captureTime),
+		_sequence(other._sequence)
 	{
 		memcpy(_pixels, other._pixels, (long) other._width * other._height * sizeof(Pixel_T));
 	}
@@ -53,12 +57,16 @@ public:
 		swap(this->_width, s._width);
 		swap(this->_height, s._height);
 		swap(this->_pixels, s._pixels);
+		swap(this->_captureTime, s._captureTime);
+		swap(this->_sequence, s._sequence);
 	}
 
 	ImageData(ImageData&& src) noexcept
 		: _width(0)
 		, _height(0)
 		, _pixels(NULL)
+		, _captureTime(0)
+		, _sequence(0)
 	{
 		src.swap(*this);
 	}
@@ -134,11 +142,29 @@ public:
 		return _pixels;
 	}
 
+	int64_t captureTime() const
+	{
+		return _captureTime;
+	}
+
+	uint64_t sequence() const
+	{
+		return _sequence;
+	}
+
+	void setCaptureInfo(int64_t captureTime, uint64_t sequence)
+	{
+		_captureTime = captureTime;
+		_sequence = sequence;
+	}
+
 	void toRgb(ImageData<ColorRgb>& image) const
 	{
 		if (image.width() != _width || image.height() != _height)
 			image.resize(_width, _height);
 
+		image.setCaptureInfo(_captureTime, _sequence);
+
 		const unsigned imageSize = _width * _height;
 
 		for (unsigned idx = 0; idx < imageSize; idx++)
@@ -164,6 +190,8 @@ public:
 		}
 
 		memset(_pixels, 0, (unsigned long) _width * _height * sizeof(Pixel_T));
+		_captureTime = 0;
+		_sequence = 0;
 	}
 
 private:
@@ -179,4 +207,8 @@ private:
 	unsigned _height;
 	/// The pixels of the image
 	Pixel_T* _pixels;
+	/// Monotonic capture timestamp in microseconds (0 if unknown)
+	int64_t _captureTime;
+	/// Frame sequence number assigned at capture (0 if unknown)
+	uint64_t _sequence;
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// util includes
+#include <utils/Image.h>
+
+namespace ImageHash {
+
+	///
+	/// @brief Calculate a fast non cryptographic 64-bit fingerprint of a memory block
+	/// @param[in]   data     The data to hash
+	/// @param[in]   size     The size of the data in bytes
+	/// @param[in]   seed     The start value, allows to include additional properties
+	/// @return               The fingerprint
+	///
+	uint64_t hash(const uint8_t* data, size_t size, uint64_t seed = 0);
+
+	///
+	/// @brief Calculate a fingerprint of the pixels and dimension of an image, used to detect unchanged frames
+	/// @param[in]   image    The image to hash
+	/// @return               The fingerprint
+	///
+	template <typename Pixel_T>
+	uint64_t hash(const Image<Pixel_T>& image)
+	{
+		const uint64_t dimension = (uint64_t(image.width()) << 32) | image.height();
+		return hash(reinterpret_cast<const uint8_t*>(image.memptr()), image.size(), dimension);
+	}
+}
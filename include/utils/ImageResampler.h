@@ -5,6 +5,13 @@
 #include <utils/Image.h>
 #include <utils/ColorRgb.h>
 
+// stl
+#include <vector>
+
+// qt
+#include <QRectF>
+#include <QVector>
+
 class ImageResampler
 {
 public:
@@ -15,7 +22,48 @@ public:
 	void setVerticalPixelDecimation(int decimator);
 	void setCropping(int cropLeft, int cropRight, int cropTop, int cropBottom);
 	void setVideoMode(VideoMode mode);
-	void processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> & outputImage) const;
+
+	///
+	/// @brief Average all pixels of a decimation block (box filter) instead of sampling its center pixel.
+	/// Avoids flicker from aliasing with a high decimation.
+	/// @param enable  True to average
+	///
+	void setAverageDecimation(bool enable);
+	bool getAverageDecimation() const { return _averageDecimation; }
+
+	///
+	/// @brief Convert only the given areas of the output image, the remaining pixels are blackened.
+	/// Skips the conversion of the pixels which are not read by the led layouts.
+	/// @param region  The areas in relative coordinates (0..1) of the output image, empty converts the full image
+	///
+	void setRegion(const QVector<QRectF>& region);
+	const QVector<QRectF>& getRegion() const { return _region; }
+
+	///
+	/// @brief Get the largest factor (1, 2, 4 or 8) a decoder may downscale a frame by before processImage(),
+	///        the horizontal and vertical decimation are multiples of it. Used to decode MJPEG with DCT scaling.
+	///
+	int getSourceScale() const;
+
+	///
+	/// @brief Check if processImage() would copy a source frame which is downscaled by the given factor unchanged
+	///        (no cropping, 2D and a decimation equal to the factor). The frame may be decoded into the output image.
+	/// @param sourceScale  The factor the frame is downscaled by
+	///
+	bool isPassThrough(int sourceScale) const;
+
+	///
+	/// @brief Crop, decimate and convert a frame to RGB
+	/// @param data          The frame
+	/// @param width         The width of the frame
+	/// @param height        The height of the frame
+	/// @param lineLength    The bytes per line of the frame
+	/// @param pixelFormat   The pixel format of the frame
+	/// @param outputImage   The converted image
+	/// @param sourceScale   The factor the frame is already downscaled by (see getSourceScale()), the cropping and
+	///                      decimation are reduced accordingly
+	///
+	void processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> & outputImage, int sourceScale = 1) const;
 
 private:
 	int _horizontalDecimation;
@@ -25,5 +73,14 @@ private:
 	int _cropTop;
 	int _cropBottom;
 	VideoMode _videoMode;
+	bool _averageDecimation;
+	QVector<QRectF> _region;
+
+	/// the output columns to convert, rasterized from _region for the output size of the last image.
+	/// The spans of row y are _regionColumns[2*i] .. _regionColumns[2*i+1] for i in _regionRows[y] .. _regionRows[y+1]
+	mutable int _regionWidth;
+	mutable int _regionHeight;
+	mutable std::vector<int> _regionRows;
+	mutable std::vector<int> _regionColumns;
 };
 
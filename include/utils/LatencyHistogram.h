@@ -0,0 +1,57 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+
+// QT includes
+#include <QJsonObject>
+
+///
+/// Histogram of latency samples with 1 millisecond buckets up to 256ms, followed by power of two
+/// millisecond buckets (<512ms, <1024ms, <2048ms, >=2048ms).
+/// Not thread safe, the owner has to serialize access.
+///
+class LatencyHistogram
+{
+public:
+	static const int LINEAR_BUCKET_COUNT = 256;
+	static const int BUCKET_COUNT = LINEAR_BUCKET_COUNT + 4;
+
+	LatencyHistogram();
+
+	///
+	/// @brief Add a sample
+	/// @param latency The latency in microseconds, negative values are ignored
+	///
+	void add(int64_t latency);
+
+	///
+	/// @brief Remove all samples
+	///
+	void reset();
+
+	///
+	/// @return The number of samples
+	///
+	uint64_t count() const { return _count; }
+
+	///
+	/// @brief Get the statistic as json object (count, min, max, avg, p50, p95, p99 in milliseconds and the counts of the non empty buckets)
+	/// @return The json representation
+	///
+	QJsonObject toJson() const;
+
+private:
+	///
+	/// @brief Estimate a percentile by interpolating inside the bucket it falls into, clamped to the minimum and maximum
+	/// @param percent The percentile 0..100
+	/// @return The latency in microseconds
+	///
+	int64_t percentile(double percent) const;
+
+	uint64_t _buckets[BUCKET_COUNT];
+	uint64_t _count;
+	int64_t _sum;
+	int64_t _min;
+	int64_t _max;
+};
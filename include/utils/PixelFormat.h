@@ -10,8 +10,13 @@ enum class PixelFormat {
 	UYVY,
 	BGR16,
 	BGR24,
+	RGB24,
 	RGB32,
 	BGR32,
+	NV12,
+	NV21,
+	I420,
+	YV12,
 #ifdef HAVE_JPEG_DECODER
 	MJPEG,
 #endif
@@ -23,32 +28,52 @@ inline PixelFormat parsePixelFormat(const QString& pixelFormat)
 	// convert to lower case
 	QString format = pixelFormat.toLower();
 
-	if (format.compare("yuyv") )
+	if (format.compare("yuyv") == 0)
 	{
 		return PixelFormat::YUYV;
 	}
-	else if (format.compare("uyvy") )
+	else if (format.compare("uyvy") == 0)
 	{
 		return PixelFormat::UYVY;
 	}
-	else if (format.compare("bgr16") )
+	else if (format.compare("bgr16") == 0)
 	{
 		return PixelFormat::BGR16;
 	}
-	else if (format.compare("bgr24") )
+	else if (format.compare("bgr24") == 0)
 	{
 		return PixelFormat::BGR24;
 	}
-	else if (format.compare("rgb32") )
+	else if (format.compare("rgb24") == 0)
+	{
+		return PixelFormat::RGB24;
+	}
+	else if (format.compare("rgb32") == 0)
 	{
 		return PixelFormat::RGB32;
 	}
-	else if (format.compare("bgr32") )
+	else if (format.compare("bgr32") == 0)
 	{
 		return PixelFormat::BGR32;
 	}
+	else if (format.compare("nv12") == 0)
+	{
+		return PixelFormat::NV12;
+	}
+	else if (format.compare("nv21") == 0)
+	{
+		return PixelFormat::NV21;
+	}
+	else if (format.compare("i420") == 0)
+	{
+		return PixelFormat::I420;
+	}
+	else if (format.compare("yv12") == 0)
+	{
+		return PixelFormat::YV12;
+	}
 #ifdef HAVE_JPEG_DECODER
-	else if (format.compare("mjpeg") )
+	else if (format.compare("mjpeg") == 0)
 	{
 		return PixelFormat::MJPEG;
 	}
@@ -57,3 +82,25 @@ inline PixelFormat parsePixelFormat(const QString& pixelFormat)
 	// return the default NO_CHANGE
 	return PixelFormat::NO_CHANGE;
 }
+
+inline QString pixelFormatToString(const PixelFormat& pixelFormat)
+{
+	switch (pixelFormat)
+	{
+		case PixelFormat::YUYV:  return "yuyv";
+		case PixelFormat::UYVY:  return "uyvy";
+		case PixelFormat::BGR16: return "bgr16";
+		case PixelFormat::BGR24: return "bgr24";
+		case PixelFormat::RGB24: return "rgb24";
+		case PixelFormat::RGB32: return "rgb32";
+		case PixelFormat::BGR32: return "bgr32";
+		case PixelFormat::NV12:  return "nv12";
+		case PixelFormat::NV21:  return "nv21";
+		case PixelFormat::I420:  return "i420";
+		case PixelFormat::YV12:  return "yv12";
+#ifdef HAVE_JPEG_DECODER
+		case PixelFormat::MJPEG: return "mjpeg";
+#endif
+		default:                 return "NO_CHANGE";
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// stl
+#include <atomic>
+#include <cstdint>
+
+// qt
+#include <QJsonDocument>
+
+// utils
+#include <utils/FrameTiming.h>
+
+///
+/// @brief Record a span named name (string literal) from here to the end of the enclosing scope.
+///        Costs a single relaxed atomic load while tracing is disabled.
+///
+#define TRACE_SCOPE(name) TraceSpan TRACE_SPAN_NAME(traceSpan_, __LINE__)(name)
+#define TRACE_SPAN_NAME(prefix, line) TRACE_SPAN_NAME_CONCAT(prefix, line)
+#define TRACE_SPAN_NAME_CONCAT(prefix, line) prefix##line
+
+///
+/// Runtime tracing of the processing stages, available in every build.
+/// Each thread records complete spans into its own ring buffer without locking,
+/// the most recent spans can be exported in the Chrome trace event format
+/// (chrome://tracing, https://ui.perfetto.dev).
+///
+class Tracer
+{
+public:
+	/// number of spans kept per thread, older spans are overwritten
+	static const uint64_t RING_BUFFER_SIZE = 16384;
+
+	///
+	/// @brief Check if spans are recorded
+	///
+	static bool isEnabled()
+	{
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// @brief Start or stop recording spans. Starting discards the spans of a previous recording.
+	/// @param enable  True to start recording
+	///
+	static void setEnabled(bool enable);
+
+	///
+	/// @brief Record a completed span of the calling thread
+	/// @param name      The name of the span, has to be a string literal (the pointer is stored)
+	/// @param start     The start time in microseconds (FrameTiming::now())
+	/// @param duration  The duration in microseconds
+	///
+	static void record(const char* name, int64_t start, int64_t duration);
+
+	///
+	/// @brief Export the recorded spans of all threads
+	/// @return JSON document in the Chrome trace event format
+	///
+	static QJsonDocument exportChromeTrace();
+
+private:
+	static std::atomic<bool> _enabled;
+};
+
+///
+/// Measures the lifetime of the object as span, use TRACE_SCOPE()
+///
+class TraceSpan
+{
+public:
+	explicit TraceSpan(const char* name)
+		: _name(Tracer::isEnabled() ? name : nullptr)
+		, _start(_name != nullptr ? FrameTiming::now() : 0)
+	{
+	}
+
+	~TraceSpan()
+	{
+		if (_name != nullptr)
+		{
+			Tracer::record(_name, _start, FrameTiming::now() - _start);
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+	/// nullptr if tracing was disabled at construction
+	const char* _name;
+	int64_t _start;
+};
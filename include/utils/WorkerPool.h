@@ -0,0 +1,49 @@
+#pragma once
+
+// stl
+#include <cstddef>
+#include <functional>
+
+// qt
+#include <QThreadPool>
+
+///
+/// Singleton thread pool shared by all hyperion instances to spread data parallel work
+/// (like led color extraction or image conversion) across the available cores.
+///
+class WorkerPool
+{
+public:
+	static WorkerPool* getInstance()
+	{
+		static WorkerPool instance;
+		return & instance;
+	}
+
+	WorkerPool(WorkerPool const&)      = delete;
+	void operator=(WorkerPool const&) = delete;
+
+	///
+	/// @brief Split the range [0, count) into chunks and process them in parallel. The calling
+	///        thread processes a chunk itself and returns once all chunks are done.
+	///        Runs serial when the range is too small to be split or when called from a worker.
+	///
+	/// @param count        The number of items to process
+	/// @param minChunkSize The minimum number of items per chunk, keeps the dispatch overhead low
+	/// @param task         Function processing the items [begin, end)
+	///
+	void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t begin, size_t end)>& task);
+
+	///
+	/// @brief Get the number of threads which process chunks, including the calling thread
+	///
+	int concurrency() const { return _concurrency; }
+
+private:
+	WorkerPool();
+
+	/// number of cores available
+	const int _concurrency;
+
+	QThreadPool _pool;
+};
@@ -30,6 +30,7 @@
 #include <utils/ColorSys.h>
 #include <utils/Process.h>
 #include <utils/JsonUtils.h>
+#include <utils/Tracer.h>
 
 // bonjour wrapper
 #ifdef ENABLE_AVAHI
@@ -38,6 +39,7 @@
 
 // ledmapping int <> string transform methods
 #include <hyperion/ImageProcessor.h>
+#include <hyperion/FrameStage.h>
 
 // api includes
 #include <api/JsonCB.h>
@@ -198,6 +200,10 @@ proceed:
 		handleInstanceCommand(message, command, tan);
 	else if (command == "leddevice")
 		handleLedDeviceCommand(message, command, tan);
+	else if (command == "latency")
+		handleLatencyCommand(message, command, tan);
+	else if (command == "tracing")
+		handleTracingCommand(message, command, tan);
 
 	// BEGIN | The following commands are derecated but used to ensure backward compatibility with hyperion Classic remote control
 	else if (command == "clearall")
@@ -494,14 +500,17 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString
 #if defined(ENABLE_V4L2)
 
 	QJsonArray availableV4L2devices;
-	for (const auto& devicePath : GrabberWrapper::getInstance()->getV4L2devices())
+	// the getters of the grabber lock the device properties, which are enumerated in the thread of the grabber
+	GrabberWrapper* grabberWrapper = GrabberWrapper::getInstance();
+	const QStringList devicePaths = (grabberWrapper != nullptr) ? grabberWrapper->getV4L2devices() : QStringList();
+	for (const auto& devicePath : devicePaths)
 	{
 		QJsonObject device;
 		device["device"] = devicePath;
-		device["name"] = GrabberWrapper::getInstance()->getV4L2deviceName(devicePath);
+		device["name"] = grabberWrapper->getV4L2deviceName(devicePath);
 
 		QJsonArray availableInputs;
-		QMultiMap<QString, int> inputs = GrabberWrapper::getInstance()->getV4L2deviceInputs(devicePath);
+		QMultiMap<QString, int> inputs = grabberWrapper->getV4L2deviceInputs(devicePath);
 		for (auto input = inputs.begin(); input != inputs.end(); input++)
 		{
 			QJsonObject availableInput;
@@ -512,7 +521,7 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString
 		device.insert("inputs", availableInputs);
 
 		QJsonArray availableResolutions;
-		QStringList resolutions = GrabberWrapper::getInstance()->getResolutions(devicePath);
+		QStringList resolutions = grabberWrapper->getResolutions(devicePath);
 		for (auto resolution : resolutions)
 		{
 			availableResolutions.append(resolution);
@@ -520,7 +529,7 @@ void JsonAPI::handleServerInfoCommand(const QJsonObject &message, const QString
 		device.insert("resolutions", availableResolutions);
 
 		QJsonArray availableFramerates;
-		QStringList framerates = GrabberWrapper::getInstance()->getFramerates(devicePath);
+		QStringList framerates = grabberWrapper->getFramerates(devicePath);
 		for (auto framerate : framerates)
 		{
 			availableFramerates.append(framerate);
@@ -1452,6 +1461,64 @@ void JsonAPI::handleLedDeviceCommand(const QJsonObject &message, const QString &
 	}
 }
 
+void JsonAPI::handleLatencyCommand(const QJsonObject &message, const QString &command, int tan)
+{
+	const QString &subc = message["subcommand"].toString().trimmed();
+	QString full_command = command + "-" + subc;
+
+	if (subc == "getstats")
+	{
+		QJsonObject stats = _hyperion->getLatencyStats();
+		stats["instance"] = int(_hyperion->getInstanceIndex());
+
+		// frame data shared between the instances
+		QJsonObject frameStage;
+		frameStage["hits"] = qint64(FrameStage::getInstance()->hits());
+		frameStage["misses"] = qint64(FrameStage::getInstance()->misses());
+		stats["frameStage"] = frameStage;
+
+		// images dropped in favour of a newer image of the same input
+		stats["coalescedFrames"] = qint64(_hyperion->getCoalescedFrames());
+		// images identical to the last processed one
+		stats["skippedFrames"] = qint64(_hyperion->getSkippedFrames());
+		sendSuccessDataReply(QJsonDocument(stats), full_command, tan);
+	}
+	else if (subc == "reset")
+	{
+		_hyperion->resetLatencyStats();
+		sendSuccessReply(full_command, tan);
+	}
+	else
+	{
+		sendErrorReply("Unknown or missing subcommand", full_command, tan);
+	}
+}
+
+void JsonAPI::handleTracingCommand(const QJsonObject &message, const QString &command, int tan)
+{
+	const QString &subc = message["subcommand"].toString().trimmed();
+	QString full_command = command + "-" + subc;
+
+	if (subc == "start")
+	{
+		Tracer::setEnabled(true);
+		sendSuccessReply(full_command, tan);
+	}
+	else if (subc == "stop")
+	{
+		Tracer::setEnabled(false);
+		sendSuccessReply(full_command, tan);
+	}
+	else if (subc == "export")
+	{
+		sendSuccessDataReply(Tracer::exportChromeTrace(), full_command, tan);
+	}
+	else
+	{
+		sendErrorReply("Unknown or missing subcommand", full_command, tan);
+	}
+}
+
 void JsonAPI::handleNotImplemented()
 {
 	sendErrorReply("Command not implemented");
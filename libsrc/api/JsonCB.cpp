@@ -227,6 +227,7 @@ void JsonCB::handlePriorityUpdate()
 	int currentPriority = _prioMuxer->getCurrentPriority();
 
 	for (int priority : activePriorities) {
+		// a copy, the muxer is modified by the thread of the instance
 		const Hyperion::InputInfo priorityInfo = _prioMuxer->getInputInfo(priority);
 		QJsonObject item;
 		item["priority"] = priority;
@@ -16,6 +16,7 @@ BlackBorderProcessor::BlackBorderProcessor(Hyperion* hyperion, QObject* parent)
 	, _maxInconsistentCnt(10)
 	, _blurRemoveCnt(1)
 	, _detectionMode("default")
+	, _detectionModeId(FrameStage::DETECTION_DEFAULT)
 	, _detector(nullptr)
 	, _currentBorder({true, -1, -1})
 	, _previousDetectedBorder({true, -1, -1})
@@ -50,6 +51,12 @@ void BlackBorderProcessor::handleSettingsUpdate(settings::type type, const QJson
 		_maxInconsistentCnt = obj["maxInconsistentCnt"].toInt(10);
 		_blurRemoveCnt = obj["blurRemoveCnt"].toInt(1);
 		_detectionMode = obj["mode"].toString("default");
+		if (_detectionMode == "classic")
+			_detectionModeId = FrameStage::DETECTION_CLASSIC;
+		else if (_detectionMode == "osd")
+			_detectionModeId = FrameStage::DETECTION_OSD;
+		else
+			_detectionModeId = FrameStage::DETECTION_DEFAULT;
 		const double newThreshold = obj["threshold"].toDouble(5.0)/100.0;
 
 		if(_oldThreshold != newThreshold)
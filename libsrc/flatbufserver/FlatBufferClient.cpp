@@ -6,6 +6,9 @@
 #include <QTimer>
 #include <QRgb>
 
+// utils
+#include <utils/FrameTiming.h>
+
 FlatBufferClient::FlatBufferClient(QTcpSocket* socket, int timeout, QObject *parent)
 	: QObject(parent)
 	, _log(Logger::getInstance("FLATBUFSERVER"))
@@ -160,6 +163,8 @@ void FlatBufferClient::handleImageCommand(const hyperionnet::Image *image)
 
 		Image<ColorRgb> imageDest(width, height);
 		memmove(imageDest.memptr(), imageData->data(), imageData->size());
+		// the remote capture time is unknown, latency is traced from the reception
+		FrameTiming::stamp(imageDest);
 		emit setGlobalInputImage(_priority, imageDest, duration);
 	}
 
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <cmath>
 #include <sstream>
 
 #include <fcntl.h>
@@ -14,10 +15,14 @@
 #include <sys/time.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <linux/videodev2.h>
 
 #include <hyperion/Hyperion.h>
 #include <hyperion/HyperionIManager.h>
+#include <utils/FrameTiming.h>
+#include <utils/CaptureRegion.h>
+#include <utils/Tracer.h>
 
 #include <QDirIterator>
 #include <QFileInfo>
@@ -30,6 +35,72 @@
 #define V4L2_CAP_META_CAPTURE 0x00800000 // Specified in kernel header v4.16. Required for backward compatibility.
 #endif
 
+// the capture thread checks for a stop request at least every CAPTURE_POLL_TIMEOUT_MS
+#define CAPTURE_POLL_TIMEOUT_MS 100
+
+// driver buffers are leased if one stays queued while a frame is pending and another one is processed
+#define LEASE_MIN_BUFFERS 3
+
+// the output images are reused, the consumers (e.g. the instance mailboxes) hold at most IMAGE_POOL_SIZE-1 of them
+#define IMAGE_POOL_SIZE 4
+
+// the automatic format negotiation captures at least AUTO_FORMAT_MIN_LED_PIXELS per led area and direction after the decimation
+#define AUTO_FORMAT_MIN_LED_PIXELS 2
+
+namespace
+{
+	///
+	/// The relative decode cost per pixel of the supported formats for the automatic format negotiation.
+	/// The raw formats cost their memory traffic (in half bytes), MJPEG adds the entropy decoding.
+	///
+	struct FormatCost
+	{
+		__u32 pixelFormat;
+		int   cost;
+	};
+
+	const FormatCost FORMAT_COSTS[] =
+	{
+		{ V4L2_PIX_FMT_NV12,   3 },
+		{ V4L2_PIX_FMT_NV21,   3 },
+		{ V4L2_PIX_FMT_YUV420, 3 },
+		{ V4L2_PIX_FMT_YVU420, 3 },
+		{ V4L2_PIX_FMT_YUYV,   4 },
+		{ V4L2_PIX_FMT_UYVY,   4 },
+		{ V4L2_PIX_FMT_RGB24,  6 },
+		{ V4L2_PIX_FMT_RGB32,  8 },
+#ifdef HAVE_JPEG_DECODER
+		{ V4L2_PIX_FMT_MJPEG,  16 },
+#endif
+	};
+
+	/// Get the decode cost of a format, 0 if it's not supported
+	int formatCost(__u32 pixelFormat)
+	{
+		for (const FormatCost& format : FORMAT_COSTS)
+		{
+			if (format.pixelFormat == pixelFormat)
+				return format.cost;
+		}
+		return 0;
+	}
+
+	///
+	/// Get the capture time of a dequeued buffer. The driver stamps it with the monotonic clock (the clock of
+	/// FrameTiming::now()) when the frame was captured, so the time it was queued in the driver counts as latency.
+	/// Drivers without monotonic timestamps fall back to the dequeue time.
+	///
+	int64_t bufferCaptureTime(const v4l2_buffer& buf)
+	{
+		const int64_t now = FrameTiming::now();
+		if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+			return now;
+
+		const int64_t captureTime = int64_t(buf.timestamp.tv_sec) * 1000000 + int64_t(buf.timestamp.tv_usec);
+		return (captureTime > 0 && captureTime <= now) ? captureTime : now;
+	}
+}
+
 V4L2Grabber::V4L2Grabber(const QString & device
 		, unsigned width
 		, unsigned height
@@ -46,6 +117,7 @@ V4L2Grabber::V4L2Grabber(const QString & device
 	, _fileDescriptor(-1)
 	, _buffers()
 	, _pixelFormat(pixelFormat)
+	, _requestedPixelFormat(pixelFormat)
 	, _pixelDecimation(-1)
 	, _lineLength(-1)
 	, _frameByteSize(-1)
@@ -60,7 +132,27 @@ V4L2Grabber::V4L2Grabber(const QString & device
 	, _y_frac_min(0.25)
 	, _x_frac_max(0.75)
 	, _y_frac_max(0.75)
-	, _streamNotifier(nullptr)
+	, _autoFormat(false)
+	, _captureRegionGeneration(0)
+	, _captureRegionValid(false)
+	, _captureThread(nullptr)
+	, _captureRunning(false)
+	, _frameMutex()
+	, _pendingLease()
+	, _pendingFrame()
+	, _pendingFrameSize(0)
+	, _pendingFrameTime(0)
+	, _pendingFrameSpan(0)
+	, _framePending(false)
+	, _processingFrame()
+	, _imagePool()
+	, _nextPoolImage(0)
+	, _rateController()
+	, _processingInterval(0)
+	, _lastPostTime(0)
+	, _droppedFrames(0)
+	, _lumaSamples()
+	, _adaptiveRate(true)
 	, _initialized(false)
 	, _deviceAutoDiscoverEnabled(false)
 {
@@ -77,6 +169,27 @@ V4L2Grabber::V4L2Grabber(const QString & device
 V4L2Grabber::~V4L2Grabber()
 {
 	uninit();
+
+#ifdef HAVE_JPEG
+	if (_decompress != nullptr)
+	{
+		jpeg_destroy_decompress(_decompress);
+		delete _decompress;
+		delete _error;
+	}
+	if (_lumaDecompress != nullptr)
+	{
+		jpeg_destroy_decompress(_lumaDecompress);
+		delete _lumaDecompress;
+		delete _lumaError;
+	}
+#endif
+#ifdef HAVE_TURBO_JPEG
+	if (_decompress != nullptr)
+		tjDestroy(_decompress);
+	if (_lumaDecompress != nullptr)
+		tjDestroy(_lumaDecompress);
+#endif
 }
 
 void V4L2Grabber::uninit()
@@ -171,8 +284,11 @@ bool V4L2Grabber::init()
 
 void V4L2Grabber::getV4Ldevices()
 {
+	// the devices are enumerated without lock and published at once, the getters are called from other threads
+	std::map<QString, QString> v4lDevices;
+	QMap<QString, V4L2Grabber::DeviceProperties> deviceProperties;
+
 	QDirIterator it("/sys/class/video4linux/", QDirIterator::NoIteratorFlags);
-	_deviceProperties.clear();
 	while(it.hasNext())
 	{
 		//_v4lDevices
@@ -267,10 +383,14 @@ void V4L2Grabber::getV4Ldevices()
 				properties.name = devName;
 				devNameFile.close();
 			}
-			_v4lDevices.emplace("/dev/"+it.fileName(), devName);
-			_deviceProperties.insert("/dev/"+it.fileName(), properties);
+			v4lDevices.emplace("/dev/"+it.fileName(), devName);
+			deviceProperties.insert("/dev/"+it.fileName(), properties);
 		}
     }
+
+	std::lock_guard<std::mutex> lock(_deviceMutex);
+	_v4lDevices.insert(v4lDevices.begin(), v4lDevices.end());
+	_deviceProperties.swap(deviceProperties);
 }
 
 void V4L2Grabber::setSignalThreshold(double redSignalThreshold, double greenSignalThreshold, double blueSignalThreshold, int noSignalCounterThreshold)
@@ -292,6 +412,7 @@ void V4L2Grabber::setSignalDetectionOffset(double horizontalMin, double vertical
 	_y_frac_min = verticalMin;
 	_x_frac_max = horizontalMax;
 	_y_frac_max = verticalMax;
+	_captureRegionValid = false;
 
 	Info(_log, "Signal detection area set to: %f,%f x %f,%f", _x_frac_min, _y_frac_min, _x_frac_max, _y_frac_max );
 }
@@ -300,10 +421,10 @@ bool V4L2Grabber::start()
 {
 	try
 	{
-		if (init() && _streamNotifier != nullptr && !_streamNotifier->isEnabled())
+		if (init() && _fileDescriptor != -1 && _captureThread == nullptr)
 		{
-			_streamNotifier->setEnabled(true);
 			start_capturing();
+			startCaptureThread();
 			Info(_log, "Started");
 			return true;
 		}
@@ -318,18 +439,252 @@ bool V4L2Grabber::start()
 
 void V4L2Grabber::stop()
 {
-	if (_streamNotifier != nullptr && _streamNotifier->isEnabled())
+	if (_captureThread != nullptr)
 	{
+		stopCaptureThread();
 		stop_capturing();
-		_streamNotifier->setEnabled(false);
 		uninit_device();
 		close_device();
 		_initialized = false;
-		_deviceProperties.clear();
+		{
+			std::lock_guard<std::mutex> lock(_deviceMutex);
+			_deviceProperties.clear();
+		}
 		Info(_log, "Stopped");
 	}
 }
 
+void V4L2Grabber::startCaptureThread()
+{
+	// the capture loop of a thread without event loop
+	class CaptureThread : public QThread
+	{
+	public:
+		explicit CaptureThread(V4L2Grabber* grabber) : _grabber(grabber) {}
+	protected:
+		void run() override { _grabber->capture(); }
+	private:
+		V4L2Grabber* _grabber;
+	};
+
+	// start at the full rate
+	_rateController.setFullInterval((_fps > 0) ? 1000000 / _fps : 0);
+	updateProcessingRate();
+	_lastPostTime = 0;
+	_droppedFrames = 0;
+	_lumaSamples.clear();
+
+	_captureRunning = true;
+	_captureThread = new CaptureThread(this);
+	_captureThread->start(QThread::HighPriority);
+}
+
+void V4L2Grabber::stopCaptureThread()
+{
+	_captureRunning = false;
+	_captureThread->wait();
+	delete _captureThread;
+	_captureThread = nullptr;
+
+	// drop a frame which was not processed yet
+	std::lock_guard<std::mutex> lock(_frameMutex);
+	_pendingLease.reset();
+	_framePending = false;
+}
+
+void V4L2Grabber::capture()
+{
+	pollfd fd;
+	fd.fd = _fileDescriptor;
+	fd.events = POLLIN;
+
+	while (_captureRunning)
+	{
+		// wake up regularly to check for a stop request
+		fd.revents = 0;
+		const int rc = poll(&fd, 1, CAPTURE_POLL_TIMEOUT_MS);
+		if (rc == -1 && errno != EINTR)
+		{
+			throw_errno_exception("poll");
+			QMetaObject::invokeMethod(this, "handleDequeueError", Qt::QueuedConnection);
+			return;
+		}
+
+		if (rc > 0 && read_frame() == -1)
+		{
+			QMetaObject::invokeMethod(this, "handleDequeueError", Qt::QueuedConnection);
+			return;
+		}
+	}
+}
+
+void V4L2Grabber::postFrame(const void *p, int size, int64_t captureTime, std::shared_ptr<const uint8_t> lease)
+{
+	// drop the frames between the processed ones while the rate is lowered, a lease is released at once
+	int64_t interval = _processingInterval.load(std::memory_order_relaxed);
+	if (interval > 0 && rawFrameChanged(static_cast<const uint8_t *>(p), size))
+	{
+		// process a changed picture at once, the full rate holds until the rate controller lowers it again
+		_processingInterval.store(0, std::memory_order_relaxed);
+		interval = 0;
+	}
+	else if (interval == 0)
+	{
+		// compare with the frames of the next lowered period only
+		_lumaSamples.clear();
+	}
+
+	if (interval > 0 && captureTime - _lastPostTime < interval - interval / 8)
+	{
+		++_droppedFrames;
+		return;
+	}
+	_lastPostTime = captureTime;
+
+	bool wasPending;
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		if (lease == nullptr)
+		{
+			_pendingFrame.resize(size_t(size));
+			memcpy(_pendingFrame.data(), p, size_t(size));
+		}
+		// a replaced lease is released, the buffer is requeued
+		_pendingLease.swap(lease);
+		_pendingFrameSize = size;
+		_pendingFrameTime = captureTime;
+		_pendingFrameSpan = (_framePending ? _pendingFrameSpan : 0) + _droppedFrames + 1;
+		_droppedFrames = 0;
+		wasPending = _framePending;
+		_framePending = true;
+	}
+
+	// a pending frame is replaced, processFrame() is already queued
+	if (!wasPending)
+		QMetaObject::invokeMethod(this, "processFrame", Qt::QueuedConnection);
+}
+
+std::shared_ptr<const uint8_t> V4L2Grabber::leaseBuffer(const v4l2_buffer& buf)
+{
+	const uint8_t* data = (_ioMethod == IO_METHOD_USERPTR)
+			? reinterpret_cast<const uint8_t*>(buf.m.userptr)
+			: static_cast<const uint8_t*>(_buffers[buf.index].start);
+
+	return std::shared_ptr<const uint8_t>(data, [this, buf](const uint8_t*)
+	{
+		// the buffers are queued again by start_capturing() after a stop
+		if (!_captureRunning)
+			return;
+
+		v4l2_buffer requeue = buf;
+		if (-1 == xioctl(VIDIOC_QBUF, &requeue))
+		{
+			throw_errno_exception("VIDIOC_QBUF");
+		}
+	});
+}
+
+Image<ColorRgb>& V4L2Grabber::acquireImage()
+{
+	for (Image<ColorRgb>& image : _imagePool)
+	{
+		if (!image.isShared())
+			return image;
+	}
+
+	// the consumers keep the previous images, the oldest one is left to them
+	if (_imagePool.size() < IMAGE_POOL_SIZE)
+	{
+		_imagePool.emplace_back(0, 0);
+		return _imagePool.back();
+	}
+
+	Image<ColorRgb>& image = _imagePool[_nextPoolImage];
+	_nextPoolImage = (_nextPoolImage + 1) % _imagePool.size();
+	image = Image<ColorRgb>(0, 0);
+	return image;
+}
+
+void V4L2Grabber::processFrame()
+{
+	std::shared_ptr<const uint8_t> lease;
+	int size;
+	int64_t captureTime;
+	unsigned frameSpan;
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		if (!_framePending)
+			return;
+
+		if (_pendingLease != nullptr)
+			lease.swap(_pendingLease);
+		else
+			_pendingFrame.swap(_processingFrame);
+
+		size = _pendingFrameSize;
+		captureTime = _pendingFrameTime;
+		frameSpan = _pendingFrameSpan;
+		_framePending = false;
+	}
+
+	// the lease is released after processing
+	process_image((lease != nullptr) ? static_cast<const void *>(lease.get()) : static_cast<const void *>(_processingFrame.data()), size, captureTime, frameSpan);
+}
+
+bool V4L2Grabber::rawFrameChanged(const uint8_t * data, int size)
+{
+	// the sampled channel is the luma of the YUV formats and the green channel of the RGB formats
+	unsigned offset = 0;
+	unsigned pixelStride = 1;
+	switch (_pixelFormat)
+	{
+		case PixelFormat::YUYV:  offset = 0; pixelStride = 2; break;
+		case PixelFormat::UYVY:  offset = 1; pixelStride = 2; break;
+		case PixelFormat::BGR16: offset = 1; pixelStride = 2; break;
+		case PixelFormat::BGR24:
+		case PixelFormat::RGB24: offset = 1; pixelStride = 3; break;
+		case PixelFormat::RGB32:
+		case PixelFormat::BGR32: offset = 1; pixelStride = 4; break;
+		case PixelFormat::NV12:
+		case PixelFormat::NV21:
+		case PixelFormat::I420:
+		case PixelFormat::YV12:  offset = 0; pixelStride = 1; break;
+#ifdef HAVE_JPEG_DECODER
+		case PixelFormat::MJPEG:
+		{
+			// most USB grabbers deliver MJPEG only, a cheap decode of the DC coefficients shows a change
+			int width, height;
+			return decodeJpegLuma(data, size, width, height)
+				&& CaptureRateController::lumaChanged(_lumaBuffer.data(), unsigned(width), unsigned(height), unsigned(width), 1, _lumaSamples);
+		}
+#endif
+		default:
+			// a frame which can't be sampled is checked when it's processed
+			return false;
+	}
+
+	if (_width <= 0 || _height <= 0 || _lineLength <= 0 || size < _lineLength * (_height - 1) + _width * int(pixelStride))
+		return false;
+
+	return CaptureRateController::lumaChanged(data + offset, unsigned(_width), unsigned(_height), unsigned(_lineLength), pixelStride, _lumaSamples);
+}
+
+void V4L2Grabber::updateProcessingRate()
+{
+	_processingInterval.store((!_adaptiveRate || _rateController.isFullRate()) ? 0 : _rateController.interval(), std::memory_order_relaxed);
+}
+
+void V4L2Grabber::handleDequeueError()
+{
+	stop();
+	getV4Ldevices();
+}
+
+void V4L2Grabber::handleReadError(const QString& error)
+{
+	emit readError(QSTRING_CSTR(error));
+}
+
 bool V4L2Grabber::open_device()
 {
 	struct stat st;
@@ -354,10 +709,6 @@ bool V4L2Grabber::open_device()
 		return false;
 	}
 
-	// create the notifier for when a new frame is available
-	_streamNotifier = new QSocketNotifier(_fileDescriptor, QSocketNotifier::Read);
-	_streamNotifier->setEnabled(false);
-	connect(_streamNotifier, &QSocketNotifier::activated, this, &V4L2Grabber::read_frame);
 	return true;
 }
 
@@ -370,9 +721,6 @@ void V4L2Grabber::close_device()
 	}
 
 	_fileDescriptor = -1;
-
-	delete _streamNotifier;
-	_streamNotifier = nullptr;
 }
 
 void V4L2Grabber::init_read(unsigned int buffer_size)
@@ -644,41 +992,65 @@ void V4L2Grabber::init_device(VideoStandard videoStandard)
 		return;
 	}
 
-	// set the requested pixel format
-	switch (_pixelFormat)
+	// negotiate the pixel format and resolution or set the requested ones
+	if (!_autoFormat || !negotiateFormat(fmt))
 	{
-		case PixelFormat::UYVY:
-			fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_UYVY;
-		break;
+		// set the requested pixel format
+		switch (_requestedPixelFormat)
+		{
+			case PixelFormat::UYVY:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_UYVY;
+			break;
 
-		case PixelFormat::YUYV:
-			fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
-		break;
+			case PixelFormat::YUYV:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+			break;
 
-		case PixelFormat::RGB32:
-			fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB32;
-		break;
+			case PixelFormat::RGB32:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB32;
+			break;
 
-#ifdef HAVE_JPEG_DECODER
-		case PixelFormat::MJPEG:
-		{
-			fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
-			fmt.fmt.pix.field       = V4L2_FIELD_ANY;
-		}
-		break;
-#endif
+			case PixelFormat::RGB24:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
+			break;
 
-		case PixelFormat::NO_CHANGE:
-		default:
-			// No change to device settings
+			case PixelFormat::NV12:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV12;
 			break;
-	}
 
-	// set custom resolution for width and height if they are not zero
-	if(_width && _height)
-	{
-		fmt.fmt.pix.width = _width;
-		fmt.fmt.pix.height = _height;
+			case PixelFormat::NV21:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV21;
+			break;
+
+			case PixelFormat::I420:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
+			break;
+
+			case PixelFormat::YV12:
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YVU420;
+			break;
+
+	#ifdef HAVE_JPEG_DECODER
+			case PixelFormat::MJPEG:
+			{
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+				fmt.fmt.pix.field       = V4L2_FIELD_ANY;
+			}
+			break;
+	#endif
+
+			case PixelFormat::NO_CHANGE:
+			default:
+				// No change to device settings
+				break;
+		}
+
+		// set custom resolution for width and height if they are not zero
+		if(_width && _height)
+		{
+			fmt.fmt.pix.width = _width;
+			fmt.fmt.pix.height = _height;
+		}
 	}
 
 	// set the settings
@@ -744,6 +1116,46 @@ void V4L2Grabber::init_device(VideoStandard videoStandard)
 		}
 		break;
 
+		case V4L2_PIX_FMT_RGB24:
+		{
+			_pixelFormat = PixelFormat::RGB24;
+			_frameByteSize = _width * _height * 3;
+			Debug(_log, "Pixel format=RGB24");
+		}
+		break;
+
+		case V4L2_PIX_FMT_NV12:
+		{
+			_pixelFormat = PixelFormat::NV12;
+			_frameByteSize = (_width * _height * 3) / 2;
+			Debug(_log, "Pixel format=NV12");
+		}
+		break;
+
+		case V4L2_PIX_FMT_NV21:
+		{
+			_pixelFormat = PixelFormat::NV21;
+			_frameByteSize = (_width * _height * 3) / 2;
+			Debug(_log, "Pixel format=NV21");
+		}
+		break;
+
+		case V4L2_PIX_FMT_YUV420:
+		{
+			_pixelFormat = PixelFormat::I420;
+			_frameByteSize = (_width * _height * 3) / 2;
+			Debug(_log, "Pixel format=I420");
+		}
+		break;
+
+		case V4L2_PIX_FMT_YVU420:
+		{
+			_pixelFormat = PixelFormat::YV12;
+			_frameByteSize = (_width * _height * 3) / 2;
+			Debug(_log, "Pixel format=YV12");
+		}
+		break;
+
 #ifdef HAVE_JPEG_DECODER
 		case V4L2_PIX_FMT_MJPEG:
 		{
@@ -755,9 +1167,9 @@ void V4L2Grabber::init_device(VideoStandard videoStandard)
 
 		default:
 #ifdef HAVE_JPEG_DECODER
-			throw_exception("Only pixel formats UYVY, YUYV, RGB32 and MJPEG are supported");
+			throw_exception("Only pixel formats UYVY, YUYV, RGB32, RGB24, NV12, NV21, I420, YV12 and MJPEG are supported");
 #else
-			throw_exception("Only pixel formats UYVY, YUYV, and RGB32 are supported");
+			throw_exception("Only pixel formats UYVY, YUYV, RGB32, RGB24, NV12, NV21, I420 and YV12 are supported");
 #endif
 		return;
 	}
@@ -917,7 +1329,8 @@ int V4L2Grabber::read_frame()
 					}
 				}
 
-				rc = process_image(_buffers[0].start, size);
+				postFrame(_buffers[0].start, size, FrameTiming::now(), nullptr);
+				rc = true;
 			}
 			break;
 
@@ -937,23 +1350,28 @@ int V4L2Grabber::read_frame()
 
 						case EIO: /* Could ignore EIO, see spec. */
 						default:
-						{
 							throw_errno_exception("VIDIOC_DQBUF");
-							stop();
-							getV4Ldevices();
-						}
-						return 0;
+						return -1;
 					}
 				}
 
 				assert(buf.index < _buffers.size());
 
-				rc = process_image(_buffers[buf.index].start, buf.bytesused);
-
-				if (-1 == xioctl(VIDIOC_QBUF, &buf))
+				// the processing of this frame overlaps the capture of the next, in the leased buffer or a copy
+				rc = true;
+				if (_buffers.size() >= LEASE_MIN_BUFFERS)
 				{
-					throw_errno_exception("VIDIOC_QBUF");
-					return 0;
+					postFrame(_buffers[buf.index].start, buf.bytesused, bufferCaptureTime(buf), leaseBuffer(buf));
+				}
+				else
+				{
+					postFrame(_buffers[buf.index].start, buf.bytesused, bufferCaptureTime(buf), nullptr);
+
+					if (-1 == xioctl(VIDIOC_QBUF, &buf))
+					{
+						throw_errno_exception("VIDIOC_QBUF");
+						return 0;
+					}
 				}
 			}
 			break;
@@ -974,12 +1392,8 @@ int V4L2Grabber::read_frame()
 
 						case EIO: /* Could ignore EIO, see spec. */
 						default:
-						{
 							throw_errno_exception("VIDIOC_DQBUF");
-							stop();
-							getV4Ldevices();
-						}
-						return 0;
+						return -1;
 					}
 				}
 
@@ -991,12 +1405,20 @@ int V4L2Grabber::read_frame()
 					}
 				}
 
-				rc = process_image((void *)buf.m.userptr, buf.bytesused);
-
-				if (-1 == xioctl(VIDIOC_QBUF, &buf))
+				rc = true;
+				if (_buffers.size() >= LEASE_MIN_BUFFERS)
 				{
-					throw_errno_exception("VIDIOC_QBUF");
-					return 0;
+					postFrame((void *)buf.m.userptr, buf.bytesused, bufferCaptureTime(buf), leaseBuffer(buf));
+				}
+				else
+				{
+					postFrame((void *)buf.m.userptr, buf.bytesused, bufferCaptureTime(buf), nullptr);
+
+					if (-1 == xioctl(VIDIOC_QBUF, &buf))
+					{
+						throw_errno_exception("VIDIOC_QBUF");
+						return 0;
+					}
 				}
 			}
 			break;
@@ -1004,14 +1426,14 @@ int V4L2Grabber::read_frame()
 	}
 	catch (std::exception& e)
 	{
-		emit readError(e.what());
+		QMetaObject::invokeMethod(this, "handleReadError", Qt::QueuedConnection, Q_ARG(QString, QString(e.what())));
 		rc = false;
 	}
 
 	return rc ? 1 : 0;
 }
 
-bool V4L2Grabber::process_image(const void *p, int size)
+bool V4L2Grabber::process_image(const void *p, int size, int64_t captureTime, unsigned frameSpan)
 {
 	// We do want a new frame...
 #ifdef HAVE_JPEG_DECODER
@@ -1024,29 +1446,29 @@ bool V4L2Grabber::process_image(const void *p, int size)
 	}
 	else
 	{
-		process_image(reinterpret_cast<const uint8_t *>(p), size);
+		process_image(reinterpret_cast<const uint8_t *>(p), size, captureTime, frameSpan);
 		return true;
 	}
 
 	return false;
 }
 
-void V4L2Grabber::process_image(const uint8_t * data, int size)
+#ifdef HAVE_JPEG_DECODER
+bool V4L2Grabber::decodeJpeg(const uint8_t * data, int size, Image<ColorRgb> & image)
 {
-	if (_cecDetectionEnabled && _cecStandbyActivated)
-		return;
+	TRACE_SCOPE("v4l2 decode");
 
-	Image<ColorRgb> image(_width, _height);
+	// decode at the reduced size of the decimation (DCT scaling), the resampler decimates the remainder
+	const int scale = _imageResampler.getSourceScale();
+	// without cropping and further decimation the frame is decoded into the image
+	const bool passThrough = _imageResampler.isPassThrough(scale);
+	int width, height;
+	uint8_t * pixels;
 
-/* ----------------------------------------------------------
- * ----------- BEGIN of JPEG decoder related code -----------
- * --------------------------------------------------------*/
-
-#ifdef HAVE_JPEG_DECODER
-	if (_pixelFormat == PixelFormat::MJPEG)
-	{
-#endif
 #ifdef HAVE_JPEG
+	// the decompressor is kept across frames
+	if (_decompress == nullptr)
+	{
 		_decompress = new jpeg_decompress_struct;
 		_error = new errorManager;
 
@@ -1055,108 +1477,202 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 		_error->pub.output_message = &outputHandler;
 
 		jpeg_create_decompress(_decompress);
+	}
 
-		if (setjmp(_error->setjmp_buffer))
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
+	if (setjmp(_error->setjmp_buffer))
+	{
+		jpeg_abort_decompress(_decompress);
+		return false;
+	}
 
-		jpeg_mem_src(_decompress, const_cast<uint8_t*>(data), size);
+	jpeg_mem_src(_decompress, const_cast<uint8_t*>(data), size);
 
-		if (jpeg_read_header(_decompress, (bool) TRUE) != JPEG_HEADER_OK)
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
+	if (jpeg_read_header(_decompress, (bool) TRUE) != JPEG_HEADER_OK)
+	{
+		jpeg_abort_decompress(_decompress);
+		return false;
+	}
 
-		_decompress->scale_num = 1;
-		_decompress->scale_denom = 1;
-		_decompress->out_color_space = JCS_RGB;
-		_decompress->dct_method = JDCT_IFAST;
+	_decompress->scale_num = 1;
+	_decompress->scale_denom = scale;
+	_decompress->out_color_space = JCS_RGB;
+	_decompress->dct_method = JDCT_IFAST;
+	_error->pub.num_warnings = 0;
 
-		if (!jpeg_start_decompress(_decompress))
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
+	if (!jpeg_start_decompress(_decompress) || _decompress->out_color_components != 3)
+	{
+		jpeg_abort_decompress(_decompress);
+		return false;
+	}
 
-		if (_decompress->out_color_components != 3)
-		{
-			jpeg_abort_decompress(_decompress);
-			jpeg_destroy_decompress(_decompress);
-			delete _decompress;
-			delete _error;
-			return;
-		}
+	width = int(_decompress->output_width);
+	height = int(_decompress->output_height);
+	if (passThrough)
+	{
+		image.resize(width, height);
+		pixels = reinterpret_cast<uint8_t*>(image.memptr());
+	}
+	else
+	{
+		_decodeBuffer.resize(size_t(width) * height * 3);
+		pixels = _decodeBuffer.data();
+	}
 
-		QImage imageFrame = QImage(_decompress->output_width, _decompress->output_height, QImage::Format_RGB888);
+	while (_decompress->output_scanline < _decompress->output_height)
+	{
+		JSAMPROW row = pixels + size_t(width) * 3 * _decompress->output_scanline;
+		jpeg_read_scanlines(_decompress, &row, 1);
+	}
 
-		int y = 0;
-		while (_decompress->output_scanline < _decompress->output_height)
-		{
-			uchar *row = imageFrame.scanLine(_decompress->output_scanline);
-			jpeg_read_scanlines(_decompress, &row, 1);
-			y++;
-		}
+	jpeg_finish_decompress(_decompress);
 
-		jpeg_finish_decompress(_decompress);
-		jpeg_destroy_decompress(_decompress);
-		delete _decompress;
-		delete _error;
+	// drop corrupted frames
+	if (_error->pub.num_warnings > 0)
+		return false;
+#endif
+#ifdef HAVE_TURBO_JPEG
+	// the decompressor is kept across frames
+	if (_decompress == nullptr && (_decompress = tjInitDecompress()) == nullptr)
+		return false;
 
-		if (imageFrame.isNull() || _error->pub.num_warnings > 0)
-			return;
+	if (tjDecompressHeader2(_decompress, const_cast<uint8_t*>(data), size, &width, &height, &_subsamp) != 0)
+		return false;
+
+	const tjscalingfactor scalingFactor = { 1, scale };
+	width = TJSCALED(width, scalingFactor);
+	height = TJSCALED(height, scalingFactor);
+	if (passThrough)
+	{
+		image.resize(width, height);
+		pixels = reinterpret_cast<uint8_t*>(image.memptr());
+	}
+	else
+	{
+		_decodeBuffer.resize(size_t(width) * height * 3);
+		pixels = _decodeBuffer.data();
+	}
+
+	if (tjDecompress2(_decompress, const_cast<uint8_t*>(data), size, pixels, width, width * 3, height, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+		return false;
+#endif
+
+	if (!passThrough)
+	{
+		// crop and decimate the remainder like the uncompressed formats, in parallel bands of rows
+		_imageResampler.processImage(pixels, width, height, width * 3, PixelFormat::RGB24, image, scale);
+	}
+	return true;
+}
+
+bool V4L2Grabber::decodeJpegLuma(const uint8_t * data, int size, int & width, int & height)
+{
+	TRACE_SCOPE("v4l2 decode luma");
+
+#ifdef HAVE_JPEG
+	// the decompressor is kept across frames
+	if (_lumaDecompress == nullptr)
+	{
+		_lumaDecompress = new jpeg_decompress_struct;
+		_lumaError = new errorManager;
+
+		_lumaDecompress->err = jpeg_std_error(&_lumaError->pub);
+		_lumaError->pub.error_exit = &errorHandler;
+		_lumaError->pub.output_message = &outputHandler;
+
+		jpeg_create_decompress(_lumaDecompress);
+	}
+
+	if (setjmp(_lumaError->setjmp_buffer))
+	{
+		jpeg_abort_decompress(_lumaDecompress);
+		return false;
+	}
+
+	jpeg_mem_src(_lumaDecompress, const_cast<uint8_t*>(data), size);
+
+	if (jpeg_read_header(_lumaDecompress, (bool) TRUE) != JPEG_HEADER_OK)
+	{
+		jpeg_abort_decompress(_lumaDecompress);
+		return false;
+	}
+
+	// a 1/8 scale takes the DC coefficient of each block, the grayscale output is the luma without color conversion
+	_lumaDecompress->scale_num = 1;
+	_lumaDecompress->scale_denom = 8;
+	_lumaDecompress->out_color_space = JCS_GRAYSCALE;
+	_lumaDecompress->dct_method = JDCT_IFAST;
+	_lumaDecompress->do_fancy_upsampling = FALSE;
+
+	if (!jpeg_start_decompress(_lumaDecompress))
+	{
+		jpeg_abort_decompress(_lumaDecompress);
+		return false;
+	}
+
+	width = int(_lumaDecompress->output_width);
+	height = int(_lumaDecompress->output_height);
+	_lumaBuffer.resize(size_t(width) * height);
+
+	while (_lumaDecompress->output_scanline < _lumaDecompress->output_height)
+	{
+		JSAMPROW row = _lumaBuffer.data() + size_t(width) * _lumaDecompress->output_scanline;
+		jpeg_read_scanlines(_lumaDecompress, &row, 1);
+	}
+
+	jpeg_finish_decompress(_lumaDecompress);
 #endif
 #ifdef HAVE_TURBO_JPEG
-		_decompress = tjInitDecompress();
-		if (_decompress == nullptr)
-			return;
+	// the decompressor is kept across frames
+	if (_lumaDecompress == nullptr && (_lumaDecompress = tjInitDecompress()) == nullptr)
+		return false;
 
-		if (tjDecompressHeader2(_decompress, const_cast<uint8_t*>(data), size, &_width, &_height, &_subsamp) != 0)
-		{
-			tjDestroy(_decompress);
-			return;
-		}
+	int subsamp;
+	if (tjDecompressHeader2(_lumaDecompress, const_cast<uint8_t*>(data), size, &width, &height, &subsamp) != 0)
+		return false;
+
+	// a 1/8 scale takes the DC coefficient of each block, the grayscale output is the luma without color conversion
+	const tjscalingfactor scalingFactor = { 1, 8 };
+	width = TJSCALED(width, scalingFactor);
+	height = TJSCALED(height, scalingFactor);
+	_lumaBuffer.resize(size_t(width) * height);
+
+	if (tjDecompress2(_lumaDecompress, const_cast<uint8_t*>(data), size, _lumaBuffer.data(), width, width, height, TJPF_GRAY, TJFLAG_FASTDCT) != 0)
+		return false;
+#endif
+	return true;
+}
+#endif
 
-		QImage imageFrame = QImage(_width, _height, QImage::Format_RGB888);
-		if (tjDecompress2(_decompress, const_cast<uint8_t*>(data), size, imageFrame.bits(), _width, 0, _height, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+void V4L2Grabber::process_image(const uint8_t * data, int size, int64_t captureTime, unsigned frameSpan)
+{
+	if (_cecDetectionEnabled && _cecStandbyActivated)
+	{
+		// the frames are dropped at the idle rate until the standby ends
+		if (_adaptiveRate)
 		{
-			tjDestroy(_decompress);
-			return;
+			_rateController.setIdle(true);
+			updateProcessingRate();
 		}
+		return;
+	}
 
-		tjDestroy(_decompress);
+	TRACE_SCOPE("v4l2 process");
 
-		if (imageFrame.isNull())
-			return;
-#endif
-#ifdef HAVE_JPEG_DECODER
-		QRect rect(_cropLeft, _cropTop, imageFrame.width() - _cropLeft - _cropRight, imageFrame.height() - _cropTop - _cropBottom);
-		imageFrame = imageFrame.copy(rect);
-		imageFrame = imageFrame.scaled(imageFrame.width() / _pixelDecimation, imageFrame.height() / _pixelDecimation,Qt::KeepAspectRatio);
+	// the capture time is taken at the dequeue, decoding is part of the traced latency.
+	// The resampler or decoder sizes the image, all of its pixels are written
+	Image<ColorRgb>& image = acquireImage();
 
-		if ((image.width() != unsigned(imageFrame.width())) || (image.height() != unsigned(imageFrame.height())))
-			image.resize(imageFrame.width(), imageFrame.height());
+	updateCaptureRegion();
 
-		for (int y=0; y<imageFrame.height(); ++y)
-			for (int x=0; x<imageFrame.width(); ++x)
-			{
-				QColor inPixel(imageFrame.pixel(x,y));
-				ColorRgb & outPixel = image(x,y);
-				outPixel.red   = inPixel.red();
-				outPixel.green = inPixel.green();
-				outPixel.blue  = inPixel.blue();
-			}
+/* ----------------------------------------------------------
+ * ----------- BEGIN of JPEG decoder related code -----------
+ * --------------------------------------------------------*/
+
+#ifdef HAVE_JPEG_DECODER
+	if (_pixelFormat == PixelFormat::MJPEG)
+	{
+		if (!decodeJpeg(data, size, image))
+			return;
 	}
 	else
 #endif
@@ -1167,6 +1683,9 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 
 	_imageResampler.processImage(data, _width, _height, _lineLength, _pixelFormat, image);
 
+	image.setCaptureInfo(captureTime, FrameTiming::nextSequence());
+
+	bool signalLost = false;
 	if (_signalDetectionEnabled)
 	{
 		// check signal (only in center of the resulting image, because some grabbers have noise values along the borders)
@@ -1191,7 +1710,15 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 
 		if (noSignal)
 		{
-			++_noSignalCounter;
+			// a frame processed at a lowered rate stands for the dropped frames, the detection time is kept
+			const int previousCounter = _noSignalCounter;
+			_noSignalCounter = qMin(_noSignalCounter + int(frameSpan), _noSignalCounterThreshold);
+
+			if (previousCounter < _noSignalCounterThreshold && _noSignalCounter == _noSignalCounterThreshold)
+			{
+				_noSignalDetected = false;
+				Info(_log, "Signal lost");
+			}
 		}
 		else
 		{
@@ -1204,20 +1731,22 @@ void V4L2Grabber::process_image(const uint8_t * data, int size)
 			_noSignalCounter = 0;
 		}
 
-		if ( _noSignalCounter < _noSignalCounterThreshold)
-		{
-			emit newFrame(image);
-		}
-		else if (_noSignalCounter == _noSignalCounterThreshold)
-		{
-			_noSignalDetected = false;
-			Info(_log, "Signal lost");
-		}
+		signalLost = (_noSignalCounter >= _noSignalCounterThreshold);
 	}
-	else
+
+	if (!signalLost)
 	{
 		emit newFrame(image);
 	}
+
+	// probe at the idle rate without signal, lower the rate while the picture is static
+	if (_adaptiveRate)
+	{
+		_rateController.setIdle(signalLost);
+		if (!signalLost)
+			_rateController.update(image, captureTime);
+		updateProcessingRate();
+	}
 }
 
 int V4L2Grabber::xioctl(int request, void *arg)
@@ -1287,15 +1816,202 @@ void V4L2Grabber::enumFrameIntervals(QStringList &framerates, int fileDescriptor
 	}
 }
 
+void V4L2Grabber::updateCaptureRegion()
+{
+	const unsigned generation = CaptureRegion::getInstance()->generation();
+	if (_captureRegionValid && generation == _captureRegionGeneration)
+		return;
+
+	_captureRegionGeneration = generation;
+	_captureRegionValid = true;
+
+	// empty if any consumer requires the full image
+	QVector<QRectF> region = CaptureRegion::getInstance()->getRegion();
+	if (!region.isEmpty() && _signalDetectionEnabled)
+	{
+		region.append(QRectF(_x_frac_min, _y_frac_min, _x_frac_max - _x_frac_min, _y_frac_max - _y_frac_min));
+	}
+
+	if (region.isEmpty() != _imageResampler.getRegion().isEmpty())
+	{
+		Debug(_log, "Convert %s", region.isEmpty() ? "the full image" : "the led areas only");
+	}
+	_imageResampler.setRegion(region);
+}
+
 void V4L2Grabber::setSignalDetectionEnable(bool enable)
 {
 	if (_signalDetectionEnabled != enable)
 	{
 		_signalDetectionEnabled = enable;
+		_captureRegionValid = false;
 		Info(_log, "Signal detection is now %s", enable ? "enabled" : "disabled");
 	}
 }
 
+bool V4L2Grabber::negotiateFormat(v4l2_format& fmt)
+{
+	const QVector<QRectF> ledAreas = CaptureRegion::getInstance()->getLedAreas();
+	if (ledAreas.isEmpty())
+	{
+		Debug(_log, "Automatic format: the led layout is unknown, use the configured format");
+		return false;
+	}
+
+	// the smallest led area in relative coordinates
+	double minWidth = 1.0, minHeight = 1.0;
+	for (const QRectF& area : ledAreas)
+	{
+		minWidth  = qMin(minWidth,  qMax(area.width(),  1e-3));
+		minHeight = qMin(minHeight, qMax(area.height(), 1e-3));
+	}
+
+	// the resolution which covers each led area with AUTO_FORMAT_MIN_LED_PIXELS after the decimation, the cropped border is captured as well
+	const int decimation = qMax(1, _pixelDecimation);
+	const unsigned requiredWidth  = unsigned(std::ceil(AUTO_FORMAT_MIN_LED_PIXELS / minWidth))  * decimation + _cropLeft + _cropRight;
+	const unsigned requiredHeight = unsigned(std::ceil(AUTO_FORMAT_MIN_LED_PIXELS / minHeight)) * decimation + _cropTop + _cropBottom;
+
+	struct Candidate
+	{
+		__u32    pixelFormat;
+		unsigned width;
+		unsigned height;
+		qint64   cost;
+		bool     sufficient;
+	} best = { 0, 0, 0, 0, false };
+
+	// prefer a sufficient resolution with the lowest cost, otherwise the largest resolution
+	auto consider = [&](__u32 pixelFormat, int cost, unsigned width, unsigned height)
+	{
+		if (!supportsFramerate(pixelFormat, width, height))
+			return;
+
+		const Candidate candidate = { pixelFormat, width, height, qint64(width) * height * cost, width >= requiredWidth && height >= requiredHeight };
+		const qint64 pixels = qint64(width) * height;
+		const qint64 bestPixels = qint64(best.width) * best.height;
+
+		if (best.pixelFormat == 0
+			|| (candidate.sufficient && (!best.sufficient || candidate.cost < best.cost))
+			|| (!candidate.sufficient && !best.sufficient && (pixels > bestPixels || (pixels == bestPixels && candidate.cost < best.cost))))
+		{
+			best = candidate;
+		}
+	};
+
+	struct v4l2_fmtdesc fmtdesc;
+	CLEAR(fmtdesc);
+	fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+	for (fmtdesc.index = 0; xioctl(VIDIOC_ENUM_FMT, &fmtdesc) >= 0; ++fmtdesc.index)
+	{
+		const int cost = formatCost(fmtdesc.pixelformat);
+		if (cost == 0)
+			continue;
+
+		struct v4l2_frmsizeenum frmsizeenum;
+		CLEAR(frmsizeenum);
+		frmsizeenum.pixel_format = fmtdesc.pixelformat;
+
+		for (frmsizeenum.index = 0; xioctl(VIDIOC_ENUM_FRAMESIZES, &frmsizeenum) >= 0; ++frmsizeenum.index)
+		{
+			if (frmsizeenum.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+			{
+				consider(fmtdesc.pixelformat, cost, frmsizeenum.discrete.width, frmsizeenum.discrete.height);
+			}
+			else
+			{
+				// the smallest step which covers the required resolution
+				const v4l2_frmsize_stepwise& range = frmsizeenum.stepwise;
+				const unsigned stepWidth  = qMax(1u, range.step_width);
+				const unsigned stepHeight = qMax(1u, range.step_height);
+				const unsigned width  = qMin(range.max_width,  range.min_width  + ((qMax(requiredWidth,  range.min_width)  - range.min_width  + stepWidth  - 1) / stepWidth)  * stepWidth);
+				const unsigned height = qMin(range.max_height, range.min_height + ((qMax(requiredHeight, range.min_height) - range.min_height + stepHeight - 1) / stepHeight) * stepHeight);
+				consider(fmtdesc.pixelformat, cost, width, height);
+				break;
+			}
+		}
+	}
+
+	if (best.pixelFormat == 0)
+	{
+		Debug(_log, "Automatic format: no supported format enumerated, use the configured format");
+		return false;
+	}
+
+	const char fourcc[5] = { char(best.pixelFormat & 0xFF), char((best.pixelFormat >> 8) & 0xFF), char((best.pixelFormat >> 16) & 0xFF), char((best.pixelFormat >> 24) & 0xFF), 0 };
+	Info(_log, "Automatic format: %s %ux%u, required by the led layout %ux%u", fourcc, best.width, best.height, requiredWidth, requiredHeight);
+
+	fmt.fmt.pix.pixelformat = best.pixelFormat;
+	fmt.fmt.pix.width       = best.width;
+	fmt.fmt.pix.height      = best.height;
+	fmt.fmt.pix.field       = V4L2_FIELD_ANY;
+	return true;
+}
+
+bool V4L2Grabber::supportsFramerate(unsigned pixelFormat, unsigned width, unsigned height)
+{
+	struct v4l2_frmivalenum frmivalenum;
+	CLEAR(frmivalenum);
+	frmivalenum.pixel_format = pixelFormat;
+	frmivalenum.width = width;
+	frmivalenum.height = height;
+
+	if (_fps <= 0 || xioctl(VIDIOC_ENUM_FRAMEINTERVALS, &frmivalenum) < 0)
+		return true;
+
+	do
+	{
+		// the shortest interval of a range
+		const v4l2_fract& interval = (frmivalenum.type == V4L2_FRMIVAL_TYPE_DISCRETE) ? frmivalenum.discrete : frmivalenum.stepwise.min;
+		if (interval.numerator != 0 && interval.denominator / interval.numerator >= unsigned(_fps))
+			return true;
+
+		++frmivalenum.index;
+	}
+	while (frmivalenum.type == V4L2_FRMIVAL_TYPE_DISCRETE && xioctl(VIDIOC_ENUM_FRAMEINTERVALS, &frmivalenum) >= 0);
+
+	return false;
+}
+
+void V4L2Grabber::setAdaptiveRate(bool enable)
+{
+	if (_adaptiveRate != enable)
+	{
+		_adaptiveRate = enable;
+		Info(_log, "Adaptive capture rate is now %s", enable ? "enabled" : "disabled");
+
+		// continue at the full rate
+		_rateController.reset();
+		updateProcessingRate();
+	}
+}
+
+void V4L2Grabber::setPixelFormat(PixelFormat pixelFormat)
+{
+	if (_requestedPixelFormat != pixelFormat)
+	{
+		_requestedPixelFormat = pixelFormat;
+		Info(_log, "Set the requested pixel format to %s", QSTRING_CSTR(pixelFormatToString(pixelFormat)));
+
+		bool started = _initialized;
+		uninit();
+		if(started) start();
+	}
+}
+
+void V4L2Grabber::setAutoFormat(bool enable)
+{
+	if (_autoFormat != enable)
+	{
+		_autoFormat = enable;
+		Info(_log, "Automatic format negotiation is now %s", enable ? "enabled" : "disabled");
+
+		bool started = _initialized;
+		uninit();
+		if(started) start();
+	}
+}
+
 void V4L2Grabber::setCecDetectionEnable(bool enable)
 {
 	if (_cecDetectionEnabled != enable)
@@ -1370,31 +2086,49 @@ bool V4L2Grabber::setFramerate(int fps)
 
 QStringList V4L2Grabber::getV4L2devices() const
 {
-	QStringList result = QStringList();
-	for (auto it = _deviceProperties.begin(); it != _deviceProperties.end(); ++it)
+	std::lock_guard<std::mutex> lock(_deviceMutex);
+	return _deviceProperties.keys();
+}
+
+QString V4L2Grabber::getDevicePath(const QString& device) const
+{
+	if (_initialized)
+		return _deviceName;
+
+	if (device.startsWith("/dev/"))
+		return device;
+
+	std::lock_guard<std::mutex> lock(_deviceMutex);
+	// init() tries the devices in the same order
+	for (auto& dev: _v4lDevices)
 	{
-		result << it.key();
+		if (device == "auto" || device.toLower() == dev.second.toLower())
+			return dev.first;
 	}
-	return result;
+	return device;
 }
 
 QString V4L2Grabber::getV4L2deviceName(const QString& devicePath) const
 {
+	std::lock_guard<std::mutex> lock(_deviceMutex);
 	return _deviceProperties.value(devicePath).name;
 }
 
 QMultiMap<QString, int> V4L2Grabber::getV4L2deviceInputs(const QString& devicePath) const
 {
+	std::lock_guard<std::mutex> lock(_deviceMutex);
 	return _deviceProperties.value(devicePath).inputs;
 }
 
 QStringList V4L2Grabber::getResolutions(const QString& devicePath) const
 {
+	std::lock_guard<std::mutex> lock(_deviceMutex);
 	return _deviceProperties.value(devicePath).resolutions;
 }
 
 QStringList V4L2Grabber::getFramerates(const QString& devicePath) const
 {
+	std::lock_guard<std::mutex> lock(_deviceMutex);
 	return _deviceProperties.value(devicePath).framerates;
 }
 
@@ -1405,6 +2139,9 @@ void V4L2Grabber::handleCecEvent(CECEvent event)
 		case CECEvent::On  :
 			Debug(_log,"CEC on event received");
 			_cecStandbyActivated = false;
+			// back to the full rate with the next frame
+			_rateController.setIdle(false);
+			updateProcessingRate();
 			return;
 		case CECEvent::Off :
 			Debug(_log,"CEC off event received");
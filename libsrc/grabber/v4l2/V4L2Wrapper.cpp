@@ -4,6 +4,8 @@
 
 // qt
 #include <QTimer>
+#include <QThread>
+#include <QJsonArray>
 
 V4L2Wrapper::V4L2Wrapper(const QString &device,
 		unsigned grabWidth,
@@ -12,8 +14,9 @@ V4L2Wrapper::V4L2Wrapper(const QString &device,
 		unsigned input,
 		VideoStandard videoStandard,
 		PixelFormat pixelFormat,
-		int pixelDecimation )
-	: GrabberWrapper("V4L2:"+device, &_grabber, grabWidth, grabHeight, 10)
+		int pixelDecimation,
+		bool additionalDevice )
+	: GrabberWrapper("V4L2:"+device, &_grabber, grabWidth, grabHeight, 10, !additionalDevice)
 	, _grabber(device,
 			grabWidth,
 			grabHeight,
@@ -22,6 +25,7 @@ V4L2Wrapper::V4L2Wrapper(const QString &device,
 			videoStandard,
 			pixelFormat,
 			pixelDecimation)
+	, _additionalDevice(additionalDevice ? device : QString())
 {
 	_ggrabber = &_grabber;
 
@@ -31,6 +35,9 @@ V4L2Wrapper::V4L2Wrapper(const QString &device,
 	// Handle the image in the captured thread using a direct connection
 	connect(&_grabber, &V4L2Grabber::newFrame, this, &V4L2Wrapper::newFrame, Qt::DirectConnection);
 	connect(&_grabber, &V4L2Grabber::readError, this, &V4L2Wrapper::readError, Qt::DirectConnection);
+
+	// the instances request the grabber by the path of the device
+	setGrabberName("V4L2:" + _grabber.getDevicePath(device));
 }
 
 V4L2Wrapper::~V4L2Wrapper()
@@ -38,9 +45,41 @@ V4L2Wrapper::~V4L2Wrapper()
 	stop();
 }
 
+void V4L2Wrapper::moveToProcessingThread(QThread* thread)
+{
+	moveToThread(thread);
+	_grabber.moveToThread(thread);
+}
+
+QJsonObject V4L2Wrapper::additionalDeviceConfig(const QJsonObject& config, const QString& device)
+{
+	for (const QJsonValue& item : config["additionalDevices"].toArray())
+	{
+		const QJsonObject additionalDevice = item.toObject();
+		if (additionalDevice["device"].toString() == device)
+		{
+			QJsonObject deviceConfig = config;
+			for (auto it = additionalDevice.begin(); it != additionalDevice.end(); ++it)
+			{
+				deviceConfig[it.key()] = it.value();
+			}
+			return deviceConfig;
+		}
+	}
+	return QJsonObject();
+}
+
 bool V4L2Wrapper::start()
 {
-	return ( _grabber.start() && GrabberWrapper::start());
+	if (!_grabber.start() || !GrabberWrapper::start())
+		return false;
+
+	// the automatic discovery may open another device than the expected one, rename after the start
+	const QString grabberName = "V4L2:" + _grabber.getDevicePath(QString());
+	if (_grabberName != grabberName)
+		QTimer::singleShot(0, this, [=]() { setGrabberName(grabberName); });
+
+	return true;
 }
 
 void V4L2Wrapper::stop()
@@ -85,6 +124,21 @@ void V4L2Wrapper::setSignalDetectionEnable(bool enable)
 	_grabber.setSignalDetectionEnable(enable);
 }
 
+void V4L2Wrapper::setAverageDecimation(bool enable)
+{
+	_grabber.setAverageDecimation(enable);
+}
+
+void V4L2Wrapper::setAdaptiveRate(bool enable)
+{
+	_grabber.setAdaptiveRate(enable);
+}
+
+void V4L2Wrapper::setAutoFormat(bool enable)
+{
+	_grabber.setAutoFormat(enable);
+}
+
 bool V4L2Wrapper::getSignalDetectionEnable() const
 {
 	return _grabber.getSignalDetectionEnabled();
@@ -114,11 +168,21 @@ void V4L2Wrapper::handleSettingsUpdate(settings::type type, const QJsonDocument&
 {
 	if(type == settings::V4L2 && _grabberName.startsWith("V4L"))
 	{
-		// extract settings
-		const QJsonObject& obj = config.object();
+		// extract settings, an additional device shares all but the device settings
+		const QJsonObject& obj = _additionalDevice.isEmpty()
+				? config.object()
+				: additionalDeviceConfig(config.object(), _additionalDevice);
+
+		// a removed additional device is deleted by the daemon
+		if (obj.isEmpty())
+			return;
 
 		// pixel decimation for v4l
 		_grabber.setPixelDecimation(obj["sizeDecimation"].toInt(8));
+		_grabber.setAverageDecimation(obj["averageDecimation"].toBool(false));
+
+		// lower the rate while the picture is static
+		_grabber.setAdaptiveRate(obj["adaptiveRate"].toBool(true));
 
 		// crop for v4l
 		_grabber.setCropping(
@@ -136,6 +200,12 @@ void V4L2Wrapper::handleSettingsUpdate(settings::type type, const QJsonDocument&
 		// device framerate
 		_grabber.setFramerate(obj["fps"].toInt(15));
 
+		// device pixel format
+		_grabber.setPixelFormat(parsePixelFormat(obj["pixelFormat"].toString("no-change")));
+
+		// negotiate the pixel format and resolution
+		_grabber.setAutoFormat(obj["autoFormat"].toBool(false));
+
 		// CEC Standby
 		_grabber.setCecDetectionEnable(obj["cecDetection"].toBool(true));
 
@@ -152,5 +222,8 @@ void V4L2Wrapper::handleSettingsUpdate(settings::type type, const QJsonDocument&
 		_grabber.setDeviceVideoStandard(
 			obj["device"].toString("auto"),
 			parseVideoStandard(obj["standard"].toString("no-change")));
+
+		// the instances request the grabber by the path of its device
+		setGrabberName("V4L2:" + _grabber.getDevicePath(obj["device"].toString("auto")));
 	}
 }
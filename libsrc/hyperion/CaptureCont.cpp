@@ -16,10 +16,13 @@ CaptureCont::CaptureCont(Hyperion* hyperion)
 	, _systemCaptPrio(0)
 	, _systemCaptName()
 	, _systemInactiveTimer(new QTimer(this))
+	, _systemMailbox(new FrameMailbox(), &QObject::deleteLater)
 	, _v4lCaptEnabled(false)
 	, _v4lCaptPrio(0)
+	, _v4lDevice()
 	, _v4lCaptName()
 	, _v4lInactiveTimer(new QTimer(this))
+	, _v4lMailbox(new FrameMailbox(), &QObject::deleteLater)
 {
 	// settings changes
 	connect(_hyperion, &Hyperion::settingsChanged, this, &CaptureCont::handleSettingsUpdate);
@@ -37,10 +40,29 @@ CaptureCont::CaptureCont(Hyperion* hyperion)
 	_v4lInactiveTimer->setSingleShot(true);
 	_v4lInactiveTimer->setInterval(1000);
 
+	// process the latest image once woken up by the mailbox, older images which were not processed in time are dropped
+	connect(_systemMailbox.get(), &FrameMailbox::frameAvailable, this, [=](quint64 generation) {
+		FrameMailbox::Frame frame;
+		if (_systemMailbox->take(frame, generation))
+			handleSystemImage(frame.source, frame.image);
+	}, Qt::QueuedConnection);
+	connect(_v4lMailbox.get(), &FrameMailbox::frameAvailable, this, [=](quint64 generation) {
+		FrameMailbox::Frame frame;
+		if (_v4lMailbox->take(frame, generation))
+			handleV4lImage(frame.source, frame.image);
+	}, Qt::QueuedConnection);
+
 	// init
 	handleSettingsUpdate(settings::INSTCAPTURE, _hyperion->getSetting(settings::INSTCAPTURE));
 }
 
+CaptureCont::~CaptureCont()
+{
+	// the grabber threads may still post, they keep the mailbox alive until they left it
+	disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _systemMailbox.get(), nullptr);
+	disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _v4lMailbox.get(), nullptr);
+}
+
 void CaptureCont::handleV4lImage(const QString& name, const Image<ColorRgb> & image)
 {
 	if(_v4lCaptName != name)
@@ -70,12 +92,20 @@ void CaptureCont::setSystemCaptureEnable(bool enable)
 		if(enable)
 		{
 			_hyperion->registerInput(_systemCaptPrio, hyperion::COMP_GRABBER);
-			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, this, &CaptureCont::handleSystemImage);
+			// the mailbox is thread safe, the grabber thread posts directly and holds it while posting
+			const std::weak_ptr<FrameMailbox> mailbox = _systemMailbox;
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _systemMailbox.get(), [=](const QString& name, const Image<ColorRgb>& image) {
+				if (const std::shared_ptr<FrameMailbox> locked = mailbox.lock())
+					locked->post({ image, name, 0, 0, false });
+			}, Qt::DirectConnection);
 			connect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _hyperion, &Hyperion::forwardSystemProtoMessage);
 		}
 		else
 		{
-			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, 0, 0);
+			// keep the connections of the other instances
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _systemMailbox.get(), nullptr);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, _hyperion, nullptr);
+			_systemMailbox->discard();
 			_hyperion->clear(_systemCaptPrio);
 			_systemInactiveTimer->stop();
 			_systemCaptName = "";
@@ -93,19 +123,35 @@ void CaptureCont::setV4LCaptureEnable(bool enable)
 		if(enable)
 		{
 			_hyperion->registerInput(_v4lCaptPrio, hyperion::COMP_V4L);
-			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, this, &CaptureCont::handleV4lImage);
-			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _hyperion, &Hyperion::forwardV4lProtoMessage);
+			// accept only the images of the requested device, the grabbers are named by their device
+			const QString grabberName = _v4lDevice.isEmpty() ? QString() : "V4L2:" + _v4lDevice;
+			// the mailbox is thread safe, the grabber thread posts directly and holds it while posting
+			const std::weak_ptr<FrameMailbox> mailbox = _v4lMailbox;
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _v4lMailbox.get(), [=](const QString& name, const Image<ColorRgb>& image) {
+				if (grabberName.isEmpty() || name == grabberName)
+				{
+					if (const std::shared_ptr<FrameMailbox> locked = mailbox.lock())
+						locked->post({ image, name, 0, 0, false });
+				}
+			}, Qt::DirectConnection);
+			connect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _hyperion, [=](const QString& name, const Image<ColorRgb>& image) {
+				if (grabberName.isEmpty() || name == grabberName)
+					emit _hyperion->forwardV4lProtoMessage(name, image);
+			});
 		}
 		else
 		{
-			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, 0, 0);
+			// keep the connections of the other instances
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _v4lMailbox.get(), nullptr);
+			disconnect(GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, _hyperion, nullptr);
+			_v4lMailbox->discard();
 			_hyperion->clear(_v4lCaptPrio);
 			_v4lInactiveTimer->stop();
 			_v4lCaptName = "";
 		}
 		_v4lCaptEnabled = enable;
 		_hyperion->setNewComponentState(hyperion::COMP_V4L, enable);
-		emit GlobalSignals::getInstance()->requestSource(hyperion::COMP_V4L, int(_hyperion->getInstanceIndex()), enable);
+		emit GlobalSignals::getInstance()->requestSource(hyperion::COMP_V4L, int(_hyperion->getInstanceIndex()), enable, _v4lDevice);
 	}
 }
 
@@ -119,6 +165,11 @@ void CaptureCont::handleSettingsUpdate(settings::type type, const QJsonDocument&
 			setV4LCaptureEnable(false); // clear prio
 			_v4lCaptPrio = obj["v4lPriority"].toInt(240);
 		}
+		if(_v4lDevice != obj["v4lDevice"].toString(""))
+		{
+			setV4LCaptureEnable(false); // release the previous device
+			_v4lDevice = obj["v4lDevice"].toString("");
+		}
 		if(_systemCaptPrio != obj["systemPriority"].toInt(250))
 		{
 			setSystemCaptureEnable(false); // clear prio
@@ -0,0 +1,101 @@
+#include <hyperion/FrameStage.h>
+
+// STL includes
+#include <algorithm>
+
+// Utils includes
+#include <utils/ImageHash.h>
+
+using namespace hyperion;
+
+FrameStage::FrameStage()
+	: _hits(0)
+	, _misses(0)
+{
+	_entries.reserve(CACHE_SIZE);
+}
+
+std::shared_ptr<FrameStage::FrameData> FrameStage::frameData(const Image<ColorRgb>& image)
+{
+	const uint64_t sequence = image.sequence();
+	if (sequence == 0)
+	{
+		return nullptr;
+	}
+
+	// a detached (modified) copy keeps the sequence, the pixel buffer tells them apart
+	const void* pixels = image.memptr();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (size_t idx = 0; idx < _entries.size(); ++idx)
+	{
+		if (_entries[idx].sequence == sequence && _entries[idx].pixels == pixels)
+		{
+			// move to front
+			std::rotate(_entries.begin(), _entries.begin() + idx, _entries.begin() + idx + 1);
+			return _entries.front().data;
+		}
+	}
+
+	if (_entries.size() == CACHE_SIZE)
+	{
+		_entries.pop_back();
+	}
+	_entries.insert(_entries.begin(), Entry{ sequence, pixels, std::make_shared<FrameData>() });
+	return _entries.front().data;
+}
+
+uint64_t FrameStage::imageHash(const Image<ColorRgb>& image)
+{
+	const std::shared_ptr<FrameData> data = frameData(image);
+	if (data == nullptr)
+	{
+		return ImageHash::hash(image);
+	}
+
+	std::lock_guard<std::mutex> lock(data->mutex);
+	if (data->hashValid)
+	{
+		++_hits;
+	}
+	else
+	{
+		++_misses;
+		data->hash = ImageHash::hash(image);
+		data->hashValid = true;
+	}
+	return data->hash;
+}
+
+BlackBorder FrameStage::detectBorder(const Image<ColorRgb>& image, const BlackBorderDetector& detector, DetectionMode mode)
+{
+	const std::shared_ptr<FrameData> data = frameData(image);
+	std::unique_lock<std::mutex> lock;
+	if (data != nullptr)
+	{
+		lock = std::unique_lock<std::mutex>(data->mutex);
+		for (const BorderResult& result : data->borders)
+		{
+			if (result.threshold == detector.threshold() && result.mode == mode)
+			{
+				++_hits;
+				return result.border;
+			}
+		}
+		++_misses;
+	}
+
+	BlackBorder border;
+	switch (mode)
+	{
+		case DETECTION_CLASSIC: border = detector.process_classic(image); break;
+		case DETECTION_OSD:     border = detector.process_osd(image); break;
+		default:                border = detector.process(image); break;
+	}
+
+	if (data != nullptr)
+	{
+		data->borders.push_back(BorderResult{ detector.threshold(), mode, border });
+	}
+	return border;
+}
@@ -35,6 +35,15 @@ void Grabber::setVideoMode(VideoMode mode)
 	}
 }
 
+void Grabber::setAverageDecimation(bool enable)
+{
+	if (_imageResampler.getAverageDecimation() != enable)
+	{
+		Debug(_log,"Set average decimation to %s", enable ? "enabled" : "disabled");
+		_imageResampler.setAverageDecimation(enable);
+	}
+}
+
 void Grabber::setCropping(unsigned cropLeft, unsigned cropRight, unsigned cropTop, unsigned cropBottom)
 {
 	if (_width>0 && _height>0)
@@ -8,30 +8,45 @@
 
 // qt
 #include <QTimer>
+#include <QMap>
+#include <QMutex>
+
+namespace {
+	/// List of Hyperion instances that requested screen capture
+	QList<int> GRABBER_SYS_CLIENTS;
+	/// Hyperion instances that requested v4l capture with the requested device, empty for any device
+	QMap<int, QString> GRABBER_V4L_CLIENTS;
+	/// The v4l grabbers handle the source requests in their own threads
+	QMutex GRABBER_CLIENTS_MUTEX;
+}
 
 GrabberWrapper* GrabberWrapper::instance = nullptr;
 
-GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz)
+GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, unsigned width, unsigned height, unsigned updateRate_Hz, bool registerInstance)
 	: _grabberName(grabberName)
 	, _timer(new QTimer(this))
 	, _updateInterval_ms(1000/updateRate_Hz)
+	, _rateController()
+	, _adaptiveRate(true)
 	, _log(Logger::getInstance(grabberName))
 	, _ggrabber(ggrabber)
 	, _image(0,0)
 {
-	GrabberWrapper::instance = this;
+	if (registerInstance)
+		GrabberWrapper::instance = this;
 
 	// Configure the timer to generate events every n milliseconds
 	_timer->setInterval(_updateInterval_ms);
+	_rateController.setFullInterval(int64_t(_updateInterval_ms) * 1000);
 
 	_image.resize(width, height);
 
 	connect(_timer, &QTimer::timeout, this, &GrabberWrapper::action);
 
-	// connect the image forwarding
+	// connect the image forwarding, direct as the receivers post to their thread safe mailbox
 	(_grabberName.startsWith("V4L"))
-		? connect(this, &GrabberWrapper::systemImage, GlobalSignals::getInstance(), &GlobalSignals::setV4lImage)
-		: connect(this, &GrabberWrapper::systemImage, GlobalSignals::getInstance(), &GlobalSignals::setSystemImage);
+		? connect(this, &GrabberWrapper::systemImage, GlobalSignals::getInstance(), &GlobalSignals::setV4lImage, Qt::DirectConnection)
+		: connect(this, &GrabberWrapper::systemImage, GlobalSignals::getInstance(), &GlobalSignals::setSystemImage, Qt::DirectConnection);
 
 	// listen for source requests
 	connect(GlobalSignals::getInstance(), &GlobalSignals::requestSource, this, &GrabberWrapper::handleSourceRequest);
@@ -39,6 +54,9 @@ GrabberWrapper::GrabberWrapper(const QString& grabberName, Grabber * ggrabber, u
 
 GrabberWrapper::~GrabberWrapper()
 {
+	if (GrabberWrapper::instance == this)
+		GrabberWrapper::instance = nullptr;
+
 	Debug(_log,"Close grabber: %s", QSTRING_CSTR(_grabberName));
 }
 
@@ -46,6 +64,8 @@ bool GrabberWrapper::start()
 {
 	// Start the timer with the pre configured interval
 	Debug(_log,"Grabber start()");
+	_rateController.reset();
+	_timer->setInterval(_updateInterval_ms);
 	_timer->start();
 	return _timer->isActive();
 }
@@ -118,11 +138,24 @@ void GrabberWrapper::setCropping(unsigned cropLeft, unsigned cropRight, unsigned
 	_ggrabber->setCropping(cropLeft, cropRight, cropTop, cropBottom);
 }
 
+void GrabberWrapper::setAdaptiveRate(bool enable)
+{
+	if (_adaptiveRate != enable)
+	{
+		_adaptiveRate = enable;
+
+		// continue at the full rate
+		_rateController.reset();
+		_timer->setInterval(_updateInterval_ms);
+	}
+}
+
 void GrabberWrapper::updateTimer(int interval)
 {
 	if(_updateInterval_ms != interval)
 	{
 		_updateInterval_ms = interval;
+		_rateController.setFullInterval(int64_t(_updateInterval_ms) * 1000);
 
 		const bool& timerWasActive = _timer->isActive();
 		_timer->stop();
@@ -161,46 +194,94 @@ void GrabberWrapper::handleSettingsUpdate(settings::type type, const QJsonDocume
 
 		// eval new update time
 		updateTimer(1000/obj["frequency_Hz"].toInt(10));
+
+		// lower the rate while the picture is static
+		setAdaptiveRate(obj["adaptiveRate"].toBool(true));
 	}
 }
 
-void GrabberWrapper::handleSourceRequest(hyperion::Components component, int hyperionInd, bool listen)
+void GrabberWrapper::handleSourceRequest(hyperion::Components component, int hyperionInd, bool listen, const QString& device)
 {
 	if(component == hyperion::Components::COMP_GRABBER  && !_grabberName.startsWith("V4L"))
 	{
+		QMutexLocker lock(&GRABBER_CLIENTS_MUTEX);
 		if(listen && !GRABBER_SYS_CLIENTS.contains(hyperionInd))
 			GRABBER_SYS_CLIENTS.append(hyperionInd);
 		else if (!listen)
 			GRABBER_SYS_CLIENTS.removeOne(hyperionInd);
-
-		if(GRABBER_SYS_CLIENTS.empty())
-			stop();
-		else
-			start();
 	}
 	else if(component == hyperion::Components::COMP_V4L && _grabberName.startsWith("V4L"))
 	{
-		if(listen && !GRABBER_V4L_CLIENTS.contains(hyperionInd))
-			GRABBER_V4L_CLIENTS.append(hyperionInd);
-		else if (!listen)
-			GRABBER_V4L_CLIENTS.removeOne(hyperionInd);
-
-		if(GRABBER_V4L_CLIENTS.empty())
-			stop();
+		// all v4l grabbers receive the request, the update is idempotent
+		QMutexLocker lock(&GRABBER_CLIENTS_MUTEX);
+		if(listen)
+			GRABBER_V4L_CLIENTS.insert(hyperionInd, device);
 		else
-			start();
+			GRABBER_V4L_CLIENTS.remove(hyperionInd);
+	}
+	else
+	{
+		return;
 	}
+
+	if(hasListeners())
+		start();
+	else
+		stop();
 }
 
 void GrabberWrapper::tryStart()
 {
 	// verify start condition
-	if((_grabberName.startsWith("V4L") && !GRABBER_V4L_CLIENTS.empty()) || (!_grabberName.startsWith("V4L") && !GRABBER_SYS_CLIENTS.empty()))
+	if(hasListeners())
 	{
 		start();
 	}
 }
 
+void GrabberWrapper::setGrabberName(const QString& grabberName)
+{
+	if(_grabberName != grabberName)
+	{
+		Debug(_log,"Rename grabber %s to %s", QSTRING_CSTR(_grabberName), QSTRING_CSTR(grabberName));
+		_grabberName = grabberName;
+
+		if(hasListeners())
+			start();
+		else
+			stop();
+	}
+}
+
+bool GrabberWrapper::hasListeners() const
+{
+	QMutexLocker lock(&GRABBER_CLIENTS_MUTEX);
+	if(!_grabberName.startsWith("V4L"))
+		return !GRABBER_SYS_CLIENTS.empty();
+
+	for (const QString& device : GRABBER_V4L_CLIENTS)
+	{
+		if(device.isEmpty() || _grabberName == "V4L2:" + device)
+			return true;
+	}
+	return false;
+}
+
+void GrabberWrapper::adaptRate(const Image<ColorRgb>& image, int64_t captureTime)
+{
+	if (!_adaptiveRate)
+		return;
+
+	// grab less often while the picture is static, at the full rate again with the first changed picture
+	_rateController.update(image, captureTime);
+
+	const int interval = int(_rateController.interval() / 1000);
+	if (_timer->interval() != interval)
+	{
+		_timer->setInterval(interval);
+	}
+}
+
 QStringList GrabberWrapper::getV4L2devices() const
 {
 	if(_grabberName.startsWith("V4L"))
@@ -6,16 +6,22 @@
 #include <QString>
 #include <QStringList>
 #include <QThread>
+#include <QMetaMethod>
 
 // hyperion include
 #include <hyperion/Hyperion.h>
 #include <hyperion/MessageForwarder.h>
 #include <hyperion/ImageProcessor.h>
 #include <hyperion/ColorAdjustment.h>
+#include <hyperion/FrameStage.h>
 
 // utils
 #include <utils/hyperion.h>
 #include <utils/GlobalSignals.h>
+#include <utils/FrameTiming.h>
+#include <utils/AllocationCounter.h>
+#include <utils/FrameMailbox.h>
+#include <utils/Tracer.h>
 #include <utils/Logger.h>
 
 // Leddevice includes
@@ -54,6 +60,10 @@ Hyperion::Hyperion(quint8 instance)
 	, _hwLedCount()
 	, _ledGridSize(hyperion::getLedLayoutGridSize(getSetting(settings::LEDS).array()))
 	, _ledBuffer(_ledString.leds().size(), ColorRgb::BLACK)
+	, _lastFrameValid(false)
+	, _lastFramePriority(-1)
+	, _lastFrameHash(0)
+	, _skippedFrames(0)
 {
 
 }
@@ -78,17 +88,22 @@ void Hyperion::start()
 
 	// handle hwLedCount
 	_hwLedCount = qMax(unsigned(getSetting(settings::DEVICE).object()["hardwareLedCount"].toInt(getLedCount())), getLedCount());
+	_ledBuffer.reserve(_hwLedCount);
 
 	// init colororder vector
 	for (const Led& led : _ledString.leds())
 	{
 		_ledStringColorOrder.push_back(led.colorOrder);
 	}
+	_raw2ledAdjustment->setLedColorOrder(_ledStringColorOrder);
 
 	// connect Hyperion::update with Muxer visible priority changes as muxer updates independent
 	connect(&_muxer, &PriorityMuxer::visiblePriorityChanged, this, &Hyperion::update);
 	connect(&_muxer, &PriorityMuxer::visibleComponentChanged, this, &Hyperion::handleVisibleComponentChanged);
 
+	// component changes (smoothing, blackborder, led device, ...) may change the output of an unchanged frame
+	connect(&_componentRegister, &ComponentRegister::updatedComponentState, this, [=]() { _lastFrameValid = false; });
+
 	// listens for ComponentRegister changes of COMP_ALL to perform core enable/disable actions
 	// connect(&_componentRegister, &ComponentRegister::updatedComponentState, this, &Hyperion::updatedComponentState);
 
@@ -105,6 +120,7 @@ void Hyperion::start()
 	_ledDeviceWrapper = new LedDeviceWrapper(this);
 	connect(this, &Hyperion::compStateChangeRequest, _ledDeviceWrapper, &LedDeviceWrapper::handleComponentState);
 	connect(this, &Hyperion::ledDeviceData, _ledDeviceWrapper, &LedDeviceWrapper::updateLeds);
+	connect(_ledDeviceWrapper, &LedDeviceWrapper::ledsWritten, this, [=](qint64 writeStart, qint64 writeEnd) { _latencyTracker.ledsWritten(writeStart, writeEnd); });
 	_ledDeviceWrapper->createLedDevice(ledDevice);
 
 	// smoothing
@@ -131,8 +147,24 @@ void Hyperion::start()
 	// forwards global signals to the corresponding slots
 	connect(GlobalSignals::getInstance(), &GlobalSignals::registerGlobalInput, this, &Hyperion::registerInput);
 	connect(GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput, this, &Hyperion::clear);
+	// drop the image which was posted before the clear, an image posted after the clear is processed after it
+	connect(GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput, this, [=](int priority) {
+		std::lock_guard<std::mutex> lock(_globalMailboxMutex);
+		for (auto it = _globalMailboxes.begin(); it != _globalMailboxes.end(); ++it)
+		{
+			if (priority < 0 || it.key() == priority)
+				it.value()->discard();
+		}
+	}, Qt::DirectConnection);
 	connect(GlobalSignals::getInstance(), &GlobalSignals::setGlobalColor, this, &Hyperion::setColor);
-	connect(GlobalSignals::getInstance(), &GlobalSignals::setGlobalImage, this, &Hyperion::setInputImage);
+	// images are delivered through a mailbox per priority, a newer image replaces one which was not processed yet
+	connect(GlobalSignals::getInstance(), &GlobalSignals::setGlobalImage, this, [=](int priority, const Image<ColorRgb>& image, int timeout_ms, bool clearEffect) {
+		std::lock_guard<std::mutex> lock(_globalMailboxMutex);
+		if (_globalMailboxesClosed)
+			return;
+
+		globalMailbox(priority)->post({ image, QString(), priority, timeout_ms, clearEffect });
+	}, Qt::DirectConnection);
 
 	// if there is no startup / background eff and no sending capture interface we probably want to push once BLACK (as PrioMuxer won't emit a prioritiy change)
 	update();
@@ -157,6 +189,16 @@ void Hyperion::freeObjects()
 	clear(-1,true);
 
 	// delete components on exit of hyperion core
+	disconnect(GlobalSignals::getInstance(), &GlobalSignals::setGlobalImage, this, nullptr);
+	disconnect(GlobalSignals::getInstance(), &GlobalSignals::clearGlobalInput, this, nullptr);
+	{
+		// queued wake ups are removed with their mailbox. disconnect() does not wait for a post which is already
+		// running in a server thread, it is dropped once it got the lock
+		std::lock_guard<std::mutex> lock(_globalMailboxMutex);
+		_globalMailboxesClosed = true;
+		qDeleteAll(_globalMailboxes);
+		_globalMailboxes.clear();
+	}
 	delete _boblightServer;
 	delete _captureCont;
 	delete _effectEngine;
@@ -166,6 +208,35 @@ void Hyperion::freeObjects()
 	delete _ledDeviceWrapper;
 }
 
+FrameMailbox* Hyperion::globalMailbox(int priority)
+{
+	// called by the posting thread with _globalMailboxMutex locked
+	FrameMailbox* mailbox = _globalMailboxes.value(priority, nullptr);
+	if (mailbox == nullptr)
+	{
+		mailbox = new FrameMailbox();
+		mailbox->moveToThread(thread());
+		connect(mailbox, &FrameMailbox::frameAvailable, mailbox, [=](quint64 generation) {
+			FrameMailbox::Frame frame;
+			if (mailbox->take(frame, generation))
+				setInputImage(frame.priority, frame.image, frame.timeout_ms, frame.clearEffect);
+		}, Qt::QueuedConnection);
+		_globalMailboxes.insert(priority, mailbox);
+	}
+	return mailbox;
+}
+
+quint64 Hyperion::getCoalescedFrames()
+{
+	quint64 coalesced = _captureCont->getCoalescedFrames();
+	std::lock_guard<std::mutex> lock(_globalMailboxMutex);
+	for (const FrameMailbox* mailbox : _globalMailboxes)
+	{
+		coalesced += mailbox->coalescedFrames();
+	}
+	return coalesced;
+}
+
 void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& config)
 {
 //	std::cout << "Hyperion::handleSettingsUpdate" << std::endl;
@@ -177,6 +248,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 		// change in color recreate ledAdjustments
 		delete _raw2ledAdjustment;
 		_raw2ledAdjustment = hyperion::createLedColorsAdjustment(_ledString.leds().size(), obj);
+		_raw2ledAdjustment->setLedColorOrder(_ledStringColorOrder);
 
 		if (!_raw2ledAdjustment->verifyAdjustments())
 		{
@@ -207,10 +279,12 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 
 		// handle hwLedCount update
 		_hwLedCount = qMax(unsigned(getSetting(settings::DEVICE).object()["hardwareLedCount"].toInt(getLedCount())), getLedCount());
+		_ledBuffer.reserve(_hwLedCount);
 
 		// change in leds are also reflected in adjustment
 		delete _raw2ledAdjustment;
 		_raw2ledAdjustment = hyperion::createLedColorsAdjustment(_ledString.leds().size(), getSetting(settings::COLOR).object());
+		_raw2ledAdjustment->setLedColorOrder(_ledStringColorOrder);
 
 		// start cached effects
 		_effectEngine->startCachedEffects();
@@ -221,6 +295,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 
 		// handle hwLedCount update
 		_hwLedCount = qMax(unsigned(dev["hardwareLedCount"].toInt(getLedCount())), getLedCount());
+		_ledBuffer.reserve(_hwLedCount);
 
 		// force ledString update, if device ByteOrder changed
 		if(_ledDeviceWrapper->getColorOrder() != dev["colorOrder"].toString("rgb"))
@@ -233,6 +308,7 @@ void Hyperion::handleSettingsUpdate(settings::type type, const QJsonDocument& co
 			{
 				_ledStringColorOrder.push_back(led.colorOrder);
 			}
+			_raw2ledAdjustment->setLedColorOrder(_ledStringColorOrder);
 		}
 
 		// do always reinit until the led devices can handle dynamic changes
@@ -344,6 +420,8 @@ bool Hyperion::setInputImage(int priority, const Image<ColorRgb>& image, int64_t
 
 	if(_muxer.setInputImage(priority, image, timeout_ms))
 	{
+		_latencyTracker.frameReceived(image.captureTime(), FrameTiming::now());
+
 		// clear effect if this call does not come from an effect
 		if(clearEffect)
 			_effectEngine->channelCleared(priority);
@@ -351,7 +429,19 @@ bool Hyperion::setInputImage(int priority, const Image<ColorRgb>& image, int64_t
 		// if this priority is visible, update immediately
 		if(priority == _muxer.getCurrentPriority())
 		{
+			// skip frames which are identical to the last processed one (static content)
+			const uint64_t frameHash = FrameStage::getInstance()->imageHash(image);
+			if (_lastFrameValid && _lastFramePriority == priority && _lastFrameHash == frameHash && _imageProcessor->isSettled())
+			{
+				_skippedFrames.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+
 			update();
+
+			_lastFrameValid    = true;
+			_lastFramePriority = priority;
+			_lastFrameHash     = frameHash;
 		}
 
 		return true;
@@ -408,6 +498,7 @@ ColorAdjustment * Hyperion::getAdjustment(const QString& id) const
 
 void Hyperion::adjustmentsUpdated()
 {
+	_raw2ledAdjustment->updateAdjustments();
 	emit adjustmentChanged();
 	update();
 }
@@ -499,6 +590,7 @@ void Hyperion::setLedMappingType(int mappingType)
 	if(mappingType != _imageProcessor->getUserLedMappingType())
 	{
 		_imageProcessor->setLedMappingType(mappingType);
+		_lastFrameValid = false;
 		emit imageToLedsMappingChanged(mappingType);
 	}
 }
@@ -532,16 +624,33 @@ void Hyperion::handleVisibleComponentChanged(hyperion::Components comp)
 
 void Hyperion::update()
 {
+	TRACE_SCOPE("update");
+
+	const int64_t processStart = FrameTiming::now();
+	const uint64_t allocationStart = AllocationCounter::threadAllocations();
+
+	// the output might not be based on the last frame of setInputImage() anymore
+	_lastFrameValid = false;
+
 	// Obtain the current priority channel
 	int priority = _muxer.getCurrentPriority();
-	const PriorityMuxer::InputInfo priorityInfo = _muxer.getInputInfo(priority);
+	const PriorityMuxer::InputInfo& priorityInfo = _muxer.getInputInfo(priority);
+	const unsigned smoothCfg = priorityInfo.smooth_cfg;
+
+	// shallow copy of the image, the muxer input may change while signals are emitted
+	const Image<ColorRgb> image = priorityInfo.image;
+
+	// image streams and the flatbuffer forwarder require the full image, otherwise the grabbers may convert the led areas only
+	_imageProcessor->updateCaptureRegion(isSignalConnected(QMetaMethod::fromSignal(&Hyperion::currentImage))
+		|| isSignalConnected(QMetaMethod::fromSignal(&Hyperion::forwardSystemProtoMessage))
+		|| isSignalConnected(QMetaMethod::fromSignal(&Hyperion::forwardV4lProtoMessage)));
 
-	// copy image & process OR copy ledColors from muxer
-	Image<ColorRgb> image = priorityInfo.image;
 	if(image.size() > 3)
 	{
 		emit currentImage(image);
-		_ledBuffer = _imageProcessor->process(image);
+		// drop the hardware padding of the previous frame, keeps the capacity
+		_ledBuffer.resize(_ledString.leds().size());
+		_imageProcessor->process(image, _ledBuffer);
 	}
 	else
 	{
@@ -551,39 +660,9 @@ void Hyperion::update()
 	// emit rawLedColors before transform
 	emit rawLedColors(_ledBuffer);
 
+	// adjust colors and correct the color byte order
 	_raw2ledAdjustment->applyAdjustment(_ledBuffer);
 
-	int i = 0;
-	for (ColorRgb& color : _ledBuffer)
-	{
-		// correct the color byte order
-		switch (_ledStringColorOrder.at(i))
-		{
-		case ColorOrder::ORDER_RGB:
-			// leave as it is
-			break;
-		case ColorOrder::ORDER_BGR:
-			std::swap(color.red, color.blue);
-			break;
-		case ColorOrder::ORDER_RBG:
-			std::swap(color.green, color.blue);
-			break;
-		case ColorOrder::ORDER_GRB:
-			std::swap(color.red, color.green);
-			break;
-		case ColorOrder::ORDER_GBR:
-			std::swap(color.red, color.green);
-			std::swap(color.green, color.blue);
-			break;
-
-		case ColorOrder::ORDER_BRG:
-			std::swap(color.red, color.blue);
-			std::swap(color.green, color.blue);
-			break;
-		}
-		i++;
-	}
-
 	// fill additional hw leds with black
 	if ( _hwLedCount > _ledBuffer.size() )
 	{
@@ -593,6 +672,8 @@ void Hyperion::update()
 	// Write the data to the device
 	if (_ledDeviceWrapper->enabled())
 	{
+		_latencyTracker.frameProcessed(image.sequence(), image.captureTime(), processStart, FrameTiming::now());
+
 		// Smoothing is disabled
 		if  (! _deviceSmooth->enabled())
 		{
@@ -601,7 +682,7 @@ void Hyperion::update()
 		}
 		else
 		{
-			_deviceSmooth->selectConfig(priorityInfo.smooth_cfg);
+			_deviceSmooth->selectConfig(smoothCfg);
 
 			// feed smoothing in pause mode to maintain a smooth transistion back to smooth mode
 			if (_deviceSmooth->enabled() || _deviceSmooth->pause())
@@ -615,4 +696,6 @@ void Hyperion::update()
 	//	/LEDDevice is disabled
 	//	Debug(_log, "LEDDevice is disabled - no update required");
 	//}
+
+	_latencyTracker.updateAllocations(AllocationCounter::threadAllocations() - allocationStart);
 }
@@ -7,6 +7,9 @@
 // Blacborder includes
 #include <blackborder/BlackBorderProcessor.h>
 
+// Utils includes
+#include <utils/CaptureRegion.h>
+
 using namespace hyperion;
 
 // global transform method
@@ -14,6 +17,8 @@ int ImageProcessor::mappingTypeToInt(const QString& mappingType)
 {
 	if (mappingType == "unicolor_mean" )
 		return 1;
+	else if (mappingType == "multicolor_mean_integral" )
+		return 2;
 
 	return 0;
 }
@@ -22,6 +27,8 @@ QString ImageProcessor::mappingTypeToStr(int mappingType)
 {
 	if (mappingType == 1 )
 		return "unicolor_mean";
+	else if (mappingType == 2 )
+		return "multicolor_mean_integral";
 
 	return "multicolor_mean";
 }
@@ -32,20 +39,29 @@ ImageProcessor::ImageProcessor(const LedString& ledString, Hyperion* hyperion)
 	, _ledString(ledString)
 	, _borderProcessor(new BlackBorderProcessor(hyperion, this))
 	, _imageToLeds(nullptr)
+	, _imageToLedsCache()
+	, _integralImage()
 	, _mappingType(0)
 	, _userMappingType(0)
 	, _hardMappingType(0)
+	, _captureRegionValid(false)
+	, _captureFullImage(true)
+	, _fullImageRequested(false)
 	, _hyperion(hyperion)
 {
 	// init
 	handleSettingsUpdate(settings::COLOR, _hyperion->getSetting(settings::COLOR));
 	// listen for changes in color - ledmapping
 	connect(_hyperion, &Hyperion::settingsChanged, this, &ImageProcessor::handleSettingsUpdate);
+
+	// the led areas are known before the first image, a grabber may negotiate its format with them
+	updateCaptureRegion(false);
 }
 
 ImageProcessor::~ImageProcessor()
 {
-	delete _imageToLeds;
+	CaptureRegion::getInstance()->removeRegion(this);
+	clearImageToLedsMaps();
 }
 
 void ImageProcessor::handleSettingsUpdate(settings::type type, const QJsonDocument& config)
@@ -69,11 +85,8 @@ void ImageProcessor::setSize(unsigned width, unsigned height)
 		return;
 	}
 
-	// Clean up the old buffer and mapping
-	delete _imageToLeds;
-
-	// Construct a new buffer and mapping
-	_imageToLeds = (width>0 && height>0) ? (new ImageToLedsMap(width, height, 0, 0, _ledString.leds())) : nullptr;
+	// Switch to the mapping of the new size
+	_imageToLeds = (width>0 && height>0) ? getImageToLedsMap(width, height, 0, 0) : nullptr;
 }
 
 void ImageProcessor::setLedString(const LedString& ledString)
@@ -86,12 +99,45 @@ void ImageProcessor::setLedString(const LedString& ledString)
 		unsigned width = _imageToLeds->width();
 		unsigned height = _imageToLeds->height();
 
-		// Clean up the old buffer and mapping
-		delete _imageToLeds;
+		// The cached mappings and the capture region belong to the old layout
+		clearImageToLedsMaps();
+		_captureRegionValid = false;
+		updateCaptureRegion(_fullImageRequested);
 
 		// Construct a new buffer and mapping
-		_imageToLeds = new ImageToLedsMap(width, height, 0, 0, _ledString.leds());
+		_imageToLeds = getImageToLedsMap(width, height, 0, 0);
+	}
+}
+
+hyperion::ImageToLedsMap* ImageProcessor::getImageToLedsMap(unsigned width, unsigned height, unsigned horizontalBorder, unsigned verticalBorder)
+{
+	for (int i = 0; i < _imageToLedsCache.size(); ++i)
+	{
+		ImageToLedsMap* map = _imageToLedsCache.at(i);
+		if (map->width() == width && map->height() == height
+			&& map->horizontalBorder() == horizontalBorder && map->verticalBorder() == verticalBorder)
+		{
+			_imageToLedsCache.move(i, 0);
+			return map;
+		}
+	}
+
+	// Evict the least recently used mapping
+	if (_imageToLedsCache.size() >= IMAGE_TO_LEDS_CACHE_SIZE)
+	{
+		delete _imageToLedsCache.takeLast();
 	}
+
+	ImageToLedsMap* map = new ImageToLedsMap(width, height, horizontalBorder, verticalBorder, _ledString.leds());
+	_imageToLedsCache.prepend(map);
+	return map;
+}
+
+void ImageProcessor::clearImageToLedsMaps()
+{
+	qDeleteAll(_imageToLedsCache);
+	_imageToLedsCache.clear();
+	_imageToLeds = nullptr;
 }
 
 void ImageProcessor::setBlackbarDetectDisable(bool enable)
@@ -104,6 +150,50 @@ bool ImageProcessor::blackBorderDetectorEnabled() const
 	return _borderProcessor->enabled();
 }
 
+bool ImageProcessor::isSettled() const
+{
+	if (_imageToLeds == nullptr)
+	{
+		return false;
+	}
+
+	// a disabled detector resets the border with the next image
+	if (!_borderProcessor->enabled())
+	{
+		return _imageToLeds->horizontalBorder() == 0 && _imageToLeds->verticalBorder() == 0;
+	}
+
+	return _borderProcessor->isSettled();
+}
+
+void ImageProcessor::updateCaptureRegion(bool fullImage)
+{
+	_fullImageRequested = fullImage;
+
+	// the black border detection scans the full image and moves the led areas by the border it detects,
+	// the unicolor mapping in use (user or forced) averages the full image
+	fullImage = fullImage || _mappingType == 1 || _borderProcessor->enabled();
+	if (_captureRegionValid && fullImage == _captureFullImage)
+	{
+		return;
+	}
+
+	_captureRegionValid = true;
+	_captureFullImage = fullImage;
+
+	QVector<QRectF> region;
+	for (const Led& led : _ledString.leds())
+	{
+		// skip leds without area like ImageToLedsMap
+		if ((led.maxX_frac-led.minX_frac) < 1e-6 || (led.maxY_frac-led.minY_frac) < 1e-6)
+		{
+			continue;
+		}
+		region.append(QRectF(led.minX_frac, led.minY_frac, led.maxX_frac-led.minX_frac, led.maxY_frac-led.minY_frac));
+	}
+	CaptureRegion::getInstance()->setRegion(this, region, fullImage);
+}
+
 void ImageProcessor::setLedMappingType(int mapType)
 {
 	// if the _hardMappingType is >-1 we aren't allowed to overwrite it
@@ -113,6 +203,7 @@ void ImageProcessor::setLedMappingType(int mapType)
 	{
 		_mappingType = mapType;
 	}
+	releaseIntegralImage();
 }
 
 void ImageProcessor::setHardLedMappingType(int mapType)
@@ -123,6 +214,16 @@ void ImageProcessor::setHardLedMappingType(int mapType)
 		_mappingType = _userMappingType;
 	else
 		_mappingType = mapType;
+	releaseIntegralImage();
+}
+
+void ImageProcessor::releaseIntegralImage()
+{
+	// the table of a large image is worth freeing once the integral mapping is not used
+	if (_mappingType != 2)
+	{
+		std::vector<uint32_t>().swap(_integralImage);
+	}
 }
 
 bool ImageProcessor::getScanParameters(size_t led, double &hscanBegin, double &hscanEnd, double &vscanBegin, double &vscanEnd) const
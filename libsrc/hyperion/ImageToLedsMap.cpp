@@ -1,5 +1,11 @@
 #include <hyperion/ImageToLedsMap.h>
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+#endif
+
 using namespace hyperion;
 
 ImageToLedsMap::ImageToLedsMap(
@@ -13,6 +19,7 @@ ImageToLedsMap::ImageToLedsMap(
 	, _horizontalBorder(horizontalBorder)
 	, _verticalBorder(verticalBorder)
 	, _colorsMap()
+	, _totalPixelCount(0)
 {
 	// Sanity check of the size of the borders (and width and height)
 	Q_ASSERT(_width  > 2*_verticalBorder);
@@ -55,24 +62,115 @@ ImageToLedsMap::ImageToLedsMap(
 			maxY_idx++;
 		}
 
-		// Add all the indices in the above defined rectangle to the indices for this led
+		// Store the above defined rectangle as a span of columns repeated for each row
 		const auto maxYLedCount = qMin(maxY_idx, yOffset+actualHeight);
 		const auto maxXLedCount = qMin(maxX_idx, xOffset+actualWidth);
 
-		std::vector<unsigned> ledColors;
-		ledColors.reserve((size_t) maxXLedCount*maxYLedCount);
+		_colorsMap.push_back({minX_idx, maxXLedCount - minX_idx, minY_idx, maxYLedCount});
+		_totalPixelCount += _colorsMap.back().pixelCount();
+	}
+}
 
-		for (unsigned y = minY_idx; y < maxYLedCount; ++y)
-		{
-			for (unsigned x = minX_idx; x < maxXLedCount; ++x)
-			{
-				ledColors.push_back(y*width + x);
-			}
-		}
+ColorRgb ImageToLedsMap::calcIntegralMeanColor(const std::vector<uint32_t> & integral, const LedSpan & span) const
+{
+	const unsigned pixelCount = span.pixelCount();
+
+	if (pixelCount == 0)
+	{
+		return ColorRgb::BLACK;
+	}
+
+	const size_t stride = size_t(_width + 1) * 3;
+	const uint32_t * top    = integral.data() + size_t(span.yStart) * stride;
+	const uint32_t * bottom = integral.data() + size_t(span.yEnd) * stride;
+	const size_t left  = size_t(span.xStart) * 3;
+	const size_t right = size_t(span.xStart + span.length) * 3;
+
+	// Sum of the area is D - B - C + A (in modular arithmetic)
+	const uint32_t sumRed   = bottom[right]     - bottom[left]     - top[right]     + top[left];
+	const uint32_t sumGreen = bottom[right + 1] - bottom[left + 1] - top[right + 1] + top[left + 1];
+	const uint32_t sumBlue  = bottom[right + 2] - bottom[left + 2] - top[right + 2] + top[left + 2];
+
+	return {uint8_t(sumRed/pixelCount), uint8_t(sumGreen/pixelCount), uint8_t(sumBlue/pixelCount)};
+}
+
+void ImageToLedsMap::accumulateRow(const ColorRgb * row, unsigned length, uint64_t & red, uint64_t & green, uint64_t & blue)
+{
+	const uint8_t * data = reinterpret_cast<const uint8_t *>(row);
+	unsigned idx = 0;
 
-		// Add the constructed vector to the map
-		_colorsMap.push_back(ledColors);
+#if defined(__SSE2__)
+	// 16 pixels are spread over three registers, the channel of a byte repeats every 3 bytes.
+	// Masking out the other channels and summing absolute differences against zero yields the
+	// per channel sums in the two 64 bit halves of each register.
+	const __m128i mask0 = _mm_setr_epi8(-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1);
+	const __m128i mask1 = _mm_setr_epi8(0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0);
+	const __m128i mask2 = _mm_setr_epi8(0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0);
+	const __m128i zero  = _mm_setzero_si128();
+
+	__m128i sumRed   = zero;
+	__m128i sumGreen = zero;
+	__m128i sumBlue  = zero;
+
+	for (; idx + 16 <= length; idx += 16, data += 48)
+	{
+		const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+		const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+		const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32));
+
+		// byte n of the 48 byte block belongs to channel n % 3
+		sumRed   = _mm_add_epi64(sumRed,   _mm_sad_epu8(_mm_and_si128(v0, mask0), zero));
+		sumRed   = _mm_add_epi64(sumRed,   _mm_sad_epu8(_mm_and_si128(v1, mask2), zero));
+		sumRed   = _mm_add_epi64(sumRed,   _mm_sad_epu8(_mm_and_si128(v2, mask1), zero));
+
+		sumGreen = _mm_add_epi64(sumGreen, _mm_sad_epu8(_mm_and_si128(v0, mask1), zero));
+		sumGreen = _mm_add_epi64(sumGreen, _mm_sad_epu8(_mm_and_si128(v1, mask0), zero));
+		sumGreen = _mm_add_epi64(sumGreen, _mm_sad_epu8(_mm_and_si128(v2, mask2), zero));
+
+		sumBlue  = _mm_add_epi64(sumBlue,  _mm_sad_epu8(_mm_and_si128(v0, mask2), zero));
+		sumBlue  = _mm_add_epi64(sumBlue,  _mm_sad_epu8(_mm_and_si128(v1, mask1), zero));
+		sumBlue  = _mm_add_epi64(sumBlue,  _mm_sad_epu8(_mm_and_si128(v2, mask0), zero));
+	}
+
+	red   += uint64_t(_mm_cvtsi128_si32(sumRed))   + uint64_t(_mm_cvtsi128_si32(_mm_srli_si128(sumRed,   8)));
+	green += uint64_t(_mm_cvtsi128_si32(sumGreen)) + uint64_t(_mm_cvtsi128_si32(_mm_srli_si128(sumGreen, 8)));
+	blue  += uint64_t(_mm_cvtsi128_si32(sumBlue))  + uint64_t(_mm_cvtsi128_si32(_mm_srli_si128(sumBlue,  8)));
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	// De-interleave 16 pixels per iteration and widen into 16 bit lanes, which are
+	// folded into 32 bit lanes every iteration so they can never overflow
+	uint32x4_t sumRed   = vdupq_n_u32(0);
+	uint32x4_t sumGreen = vdupq_n_u32(0);
+	uint32x4_t sumBlue  = vdupq_n_u32(0);
+
+	for (; idx + 16 <= length; idx += 16, data += 48)
+	{
+		const uint8x16x3_t px = vld3q_u8(data);
+		sumRed   = vpadalq_u16(sumRed,   vpaddlq_u8(px.val[0]));
+		sumGreen = vpadalq_u16(sumGreen, vpaddlq_u8(px.val[1]));
+		sumBlue  = vpadalq_u16(sumBlue,  vpaddlq_u8(px.val[2]));
+	}
+
+	const uint64x2_t red64   = vpaddlq_u32(sumRed);
+	const uint64x2_t green64 = vpaddlq_u32(sumGreen);
+	const uint64x2_t blue64  = vpaddlq_u32(sumBlue);
+	red   += vgetq_lane_u64(red64,   0) + vgetq_lane_u64(red64,   1);
+	green += vgetq_lane_u64(green64, 0) + vgetq_lane_u64(green64, 1);
+	blue  += vgetq_lane_u64(blue64,  0) + vgetq_lane_u64(blue64,  1);
+#endif
+
+	// Remaining pixels (or all of them without SIMD support)
+	uint32_t rowRed   = 0;
+	uint32_t rowGreen = 0;
+	uint32_t rowBlue  = 0;
+	for (; idx < length; ++idx, data += 3)
+	{
+		rowRed   += data[0];
+		rowGreen += data[1];
+		rowBlue  += data[2];
 	}
+	red   += rowRed;
+	green += rowGreen;
+	blue  += rowBlue;
 }
 
 unsigned ImageToLedsMap::width() const
@@ -0,0 +1,113 @@
+#include <hyperion/LatencyTracker.h>
+
+// QT includes
+#include <QMutexLocker>
+
+// util includes
+#include <utils/AllocationCounter.h>
+
+LatencyTracker::LatencyTracker()
+	: _lastSequence(0)
+	, _pending(false)
+	, _pendingCaptureTime(0)
+	, _pendingHandoverTime(0)
+	, _supersededFrames(0)
+	, _updates(0)
+	, _allocatingUpdates(0)
+	, _lastAllocations(0)
+	, _maxAllocations(0)
+	, _totalAllocations(0)
+{
+}
+
+void LatencyTracker::frameReceived(int64_t captureTime, int64_t inputTime)
+{
+	if (captureTime <= 0)
+		return;
+
+	QMutexLocker lock(&_mutex);
+	_stages[STAGE_CAPTURE].add(inputTime - captureTime);
+}
+
+void LatencyTracker::frameProcessed(uint64_t sequence, int64_t captureTime, int64_t processStart, int64_t processEnd)
+{
+	// only stamped frames are traced, a repeated update of the same frame (e.g. by a timeout) is no new frame
+	if (captureTime <= 0 || sequence == 0)
+		return;
+
+	QMutexLocker lock(&_mutex);
+	if (sequence == _lastSequence)
+		return;
+
+	_lastSequence = sequence;
+	_stages[STAGE_PROCESSING].add(processEnd - processStart);
+
+	if (_pending)
+		++_supersededFrames;
+
+	_pending = true;
+	_pendingCaptureTime = captureTime;
+	_pendingHandoverTime = processEnd;
+}
+
+void LatencyTracker::ledsWritten(int64_t writeStart, int64_t writeEnd)
+{
+	QMutexLocker lock(&_mutex);
+	// writes triggered by smoothing or refresh timers without a new frame are not measured
+	if (!_pending || writeStart < _pendingHandoverTime)
+		return;
+
+	_stages[STAGE_OUTPUT].add(writeStart - _pendingHandoverTime);
+	_stages[STAGE_DEVICE].add(writeEnd - writeStart);
+	_stages[STAGE_TOTAL].add(writeEnd - _pendingCaptureTime);
+	_pending = false;
+}
+
+void LatencyTracker::updateAllocations(uint64_t allocations)
+{
+	QMutexLocker lock(&_mutex);
+	++_updates;
+	if (allocations > 0)
+		++_allocatingUpdates;
+
+	_lastAllocations = allocations;
+	_maxAllocations = qMax(_maxAllocations, allocations);
+	_totalAllocations += allocations;
+}
+
+QJsonObject LatencyTracker::toJson() const
+{
+	QMutexLocker lock(&_mutex);
+	QJsonObject result;
+	result["capture"] = _stages[STAGE_CAPTURE].toJson();
+	result["processing"] = _stages[STAGE_PROCESSING].toJson();
+	result["output"] = _stages[STAGE_OUTPUT].toJson();
+	result["device"] = _stages[STAGE_DEVICE].toJson();
+	result["total"] = _stages[STAGE_TOTAL].toJson();
+	result["supersededFrames"] = qint64(_supersededFrames);
+
+	QJsonObject allocations;
+	allocations["enabled"] = AllocationCounter::enabled();
+	allocations["updates"] = qint64(_updates);
+	allocations["allocatingUpdates"] = qint64(_allocatingUpdates);
+	allocations["last"] = qint64(_lastAllocations);
+	allocations["max"] = qint64(_maxAllocations);
+	allocations["total"] = qint64(_totalAllocations);
+	result["allocations"] = allocations;
+	return result;
+}
+
+void LatencyTracker::reset()
+{
+	QMutexLocker lock(&_mutex);
+	for (LatencyHistogram& stage : _stages)
+		stage.reset();
+
+	_pending = false;
+	_supersededFrames = 0;
+	_updates = 0;
+	_allocatingUpdates = 0;
+	_lastAllocations = 0;
+	_maxAllocations = 0;
+	_totalAllocations = 0;
+}
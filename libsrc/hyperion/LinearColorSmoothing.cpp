@@ -4,6 +4,7 @@
 
 #include "LinearColorSmoothing.h"
 #include <hyperion/Hyperion.h>
+#include <utils/Tracer.h>
 
 #include <cmath>
 
@@ -112,6 +113,8 @@ int LinearColorSmoothing::updateLedValues(const std::vector<ColorRgb>& ledValues
 
 void LinearColorSmoothing::updateLeds()
 {
+	TRACE_SCOPE("smooth");
+
 	int64_t now = QDateTime::currentMSecsSinceEpoch();
 	int64_t deltaTime = _targetTime - now;
 
@@ -132,21 +135,7 @@ void LinearColorSmoothing::updateLeds()
 
 		float k = 1.0f - 1.0f * deltaTime / (_targetTime - _previousTime);
 
-		int reddif = 0, greendif = 0, bluedif = 0;
-
-		for (size_t i = 0; i < _previousValues.size(); ++i)
-		{
-			ColorRgb & prev   = _previousValues[i];
-			ColorRgb & target = _targetValues[i];
-
-			reddif   = target.red   - prev.red;
-			greendif = target.green - prev.green;
-			bluedif  = target.blue  - prev.blue;
-
-			prev.red   += (reddif   < 0 ? -1:1) * std::ceil(k * std::abs(reddif));
-			prev.green += (greendif < 0 ? -1:1) * std::ceil(k * std::abs(greendif));
-			prev.blue  += (bluedif  < 0 ? -1:1) * std::ceil(k * std::abs(bluedif));
-		}
+		interpolate(_previousValues, _targetValues, k);
 		_previousTime = now;
 
 		//std::cout << "LinearColorSmoothing::updateLeds> _targetValues: "; LedDevice::printLedValues ( _targetValues );
@@ -155,6 +144,25 @@ void LinearColorSmoothing::updateLeds()
 	}
 }
 
+void LinearColorSmoothing::interpolate(std::vector<ColorRgb>& previous, const std::vector<ColorRgb>& target, float k)
+{
+	int reddif = 0, greendif = 0, bluedif = 0;
+
+	for (size_t i = 0; i < previous.size(); ++i)
+	{
+		ColorRgb & prev = previous[i];
+		const ColorRgb & tgt = target[i];
+
+		reddif   = tgt.red   - prev.red;
+		greendif = tgt.green - prev.green;
+		bluedif  = tgt.blue  - prev.blue;
+
+		prev.red   += (reddif   < 0 ? -1:1) * std::ceil(k * std::abs(reddif));
+		prev.green += (greendif < 0 ? -1:1) * std::ceil(k * std::abs(greendif));
+		prev.blue  += (bluedif  < 0 ? -1:1) * std::ceil(k * std::abs(bluedif));
+	}
+}
+
 void LinearColorSmoothing::queueColors(const std::vector<ColorRgb> & ledColors)
 {
 	//Debug(_log, "queueColors -  _outputDelay[%d] _outputQueue.size() [%d], _writeToLedsEnable[%d]", _outputDelay, _outputQueue.size(), _writeToLedsEnable);
@@ -44,6 +44,14 @@ public:
 	bool pause() const { return _pause; }
 	bool enabled() const { return _enabled && !_pause; }
 
+	///
+	/// @brief Move the previous colors the given fraction towards the target colors, each step rounded away from the previous color
+	/// @param[in,out] previous  The current colors, updated in place
+	/// @param[in]     target    The target colors (at least the size of previous)
+	/// @param[in]     k         The fraction of the distance to move (0..1)
+	///
+	static void interpolate(std::vector<ColorRgb>& previous, const std::vector<ColorRgb>& target, float k);
+
 	///
 	/// @brief Add a new smoothing cfg which can be used with selectConfig()
 	/// @param   settlingTime_ms       The buffer time
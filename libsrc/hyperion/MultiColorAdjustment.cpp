@@ -1,9 +1,48 @@
 // Hyperion includes
 #include <utils/Logger.h>
+#include <utils/Tracer.h>
 #include <hyperion/MultiColorAdjustment.h>
 
+// STL includes
+#include <algorithm>
+
+namespace {
+
+///
+/// Position of each channel value in the color lookup tables. The nodes are placed at multiples
+/// of 8 with the last node at 255, the weight of the upper node is given in 1/256.
+///
+struct LutPosition
+{
+	uint8_t node[256];
+	uint16_t weight[256];
+
+	LutPosition()
+	{
+		for (int value = 0; value < 256; ++value)
+		{
+			node[value]   = uint8_t(qMin(value >> 3, 31));
+			weight[value] = uint16_t((value < 248) ? (value & 7) << 5 : ((value - 248) << 8) / 7);
+		}
+	}
+};
+
+const LutPosition lutPosition;
+
+/// Channel value of a lookup table node
+inline uint8_t lutNodeValue(int node)
+{
+	return uint8_t(qMin(node << 3, 255));
+}
+
+}
+
 MultiColorAdjustment::MultiColorAdjustment(unsigned ledCnt)
-	: _ledAdjustments(ledCnt, nullptr)
+	: _adjustmentLutsValid(false)
+	, _ledAdjustments(ledCnt, nullptr)
+	, _ledColorOrder()
+	, _ledRanges()
+	, _ledRangesValid(false)
 	, _log(Logger::getInstance("ADJUSTMENT"))
 {
 }
@@ -23,6 +62,7 @@ void MultiColorAdjustment::addAdjustment(ColorAdjustment * adjustment)
 {
 	_adjustmentIds.push_back(adjustment->_id);
 	_adjustment.push_back(adjustment);
+	_adjustmentLutsValid = false;
 }
 
 void MultiColorAdjustment::setAdjustmentForLed(const QString& id, unsigned startLed, unsigned endLed)
@@ -49,6 +89,7 @@ void MultiColorAdjustment::setAdjustmentForLed(const QString& id, unsigned start
 		//Debug(_log,"_ledAdjustments [%u] -> [%p]", iLed, adjustment);
 		_ledAdjustments[iLed] = adjustment;
 	}
+	_ledRangesValid = false;
 }
 
 bool MultiColorAdjustment::verifyAdjustments() const
@@ -95,56 +136,214 @@ void MultiColorAdjustment::setBacklightEnabled(bool enable)
 	}
 }
 
-void MultiColorAdjustment::applyAdjustment(std::vector<ColorRgb>& ledColors)
+void MultiColorAdjustment::updateAdjustments()
+{
+	_adjustmentLutsValid = false;
+}
+
+void MultiColorAdjustment::setLedColorOrder(const std::vector<ColorOrder>& ledColorOrder)
+{
+	_ledColorOrder = ledColorOrder;
+	_ledRangesValid = false;
+}
+
+void MultiColorAdjustment::updateLedRanges()
 {
-	const size_t itCnt = qMin(_ledAdjustments.size(), ledColors.size());
-	for (size_t i=0; i<itCnt; ++i)
+	_ledRanges.clear();
+
+	for (size_t i=0; i<_ledAdjustments.size(); ++i)
 	{
 		ColorAdjustment* adjustment = _ledAdjustments[i];
-		if (adjustment == nullptr)
+		const ColorOrder order = (i < _ledColorOrder.size()) ? _ledColorOrder[i] : ColorOrder::ORDER_RGB;
+
+		uint8_t channelOrder[3];
+		switch (order)
+		{
+		case ColorOrder::ORDER_BGR: channelOrder[0] = 2; channelOrder[1] = 1; channelOrder[2] = 0; break;
+		case ColorOrder::ORDER_RBG: channelOrder[0] = 0; channelOrder[1] = 2; channelOrder[2] = 1; break;
+		case ColorOrder::ORDER_GRB: channelOrder[0] = 1; channelOrder[1] = 0; channelOrder[2] = 2; break;
+		case ColorOrder::ORDER_GBR: channelOrder[0] = 1; channelOrder[1] = 2; channelOrder[2] = 0; break;
+		case ColorOrder::ORDER_BRG: channelOrder[0] = 2; channelOrder[1] = 0; channelOrder[2] = 1; break;
+		case ColorOrder::ORDER_RGB:
+		default:                    channelOrder[0] = 0; channelOrder[1] = 1; channelOrder[2] = 2; break;
+		}
+
+		// extend the current range when adjustment and order are the same
+		if (!_ledRanges.empty())
 		{
-			//std::cout << "MultiColorAdjustment::applyAdjustment() - No transform set for this led : " << i << std::endl;
-			// No transform set for this led (do nothing)
-			continue;
+			LedRange& last = _ledRanges.back();
+			if (last.adjustment == adjustment && std::equal(channelOrder, channelOrder+3, last.channelOrder))
+			{
+				last.end = i+1;
+				continue;
+			}
 		}
-		ColorRgb& color = ledColors[i];
-
-		uint8_t ored   = color.red;
-		uint8_t ogreen = color.green;
-		uint8_t oblue  = color.blue;
-		uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
-
-		adjustment->_rgbTransform.transform(ored,ogreen,oblue);
-		adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
-
-		uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
-		uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
-		uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
-		uint32_t rg   = (uint32_t) (ored)    *(ogreen);
-
-		uint8_t black   = nrng*(255-oblue)/65025;
-		uint8_t red     = rng *(255-oblue)/65025;
-		uint8_t green   = nrg *(255-oblue)/65025;
-		uint8_t blue    = nrng*(oblue)    /65025;
-		uint8_t cyan    = nrg *(oblue)    /65025;
-		uint8_t magenta = rng *(oblue)    /65025;
-		uint8_t yellow  = rg  *(255-oblue)/65025;
-		uint8_t white   = rg  *(oblue)    /65025;
-
-		uint8_t OR, OG, OB, RR, RG, RB, GR, GG, GB, BR, BG, BB;
-		uint8_t CR, CG, CB, MR, MG, MB, YR, YG, YB, WR, WG, WB;
-
-		adjustment->_rgbBlackAdjustment.apply  (black  , 255  , OR, OG, OB);
-		adjustment->_rgbRedAdjustment.apply    (red    , B_RGB, RR, RG, RB);
-		adjustment->_rgbGreenAdjustment.apply  (green  , B_RGB, GR, GG, GB);
-		adjustment->_rgbBlueAdjustment.apply   (blue   , B_RGB, BR, BG, BB);
-		adjustment->_rgbCyanAdjustment.apply   (cyan   , B_CMY, CR, CG, CB);
-		adjustment->_rgbMagentaAdjustment.apply(magenta, B_CMY, MR, MG, MB);
-		adjustment->_rgbYellowAdjustment.apply (yellow , B_CMY, YR, YG, YB);
-		adjustment->_rgbWhiteAdjustment.apply  (white  , B_W  , WR, WG, WB);
-
-		color.red   = OR + RR + GR + BR + CR + MR + YR + WR;
-		color.green = OG + RG + GG + BG + CG + MG + YG + WG;
-		color.blue  = OB + RB + GB + BB + CB + MB + YB + WB;
+
+		const ColorRgb* lut = nullptr;
+		if (adjustment != nullptr)
+		{
+			const size_t idx = std::find(_adjustment.begin(), _adjustment.end(), adjustment) - _adjustment.begin();
+			lut = _adjustmentLuts[idx].data();
+		}
+
+		_ledRanges.push_back({i, i+1, adjustment, lut, {channelOrder[0], channelOrder[1], channelOrder[2]}});
+	}
+
+	_ledRangesValid = true;
+}
+
+void MultiColorAdjustment::updateLuts()
+{
+	const size_t lutEntries = LUT_SIZE * LUT_SIZE * LUT_SIZE;
+
+	if (_adjustmentLuts.size() != _adjustment.size())
+	{
+		_adjustmentLuts.resize(_adjustment.size());
+		_ledRangesValid = false;
 	}
+
+	for (size_t i=0; i<_adjustment.size(); ++i)
+	{
+		// rebuild in place, the ranges keep pointing to the tables
+		std::vector<ColorRgb>& lut = _adjustmentLuts[i];
+		if (lut.size() != lutEntries)
+		{
+			lut.resize(lutEntries);
+			_ledRangesValid = false;
+		}
+
+		ColorRgb* node = lut.data();
+		for (int r=0; r<LUT_SIZE; ++r)
+		{
+			for (int g=0; g<LUT_SIZE; ++g)
+			{
+				for (int b=0; b<LUT_SIZE; ++b)
+				{
+					*node++ = adjustColor(_adjustment[i], lutNodeValue(r), lutNodeValue(g), lutNodeValue(b));
+				}
+			}
+		}
+	}
+
+	_adjustmentLutsValid = true;
+}
+
+void MultiColorAdjustment::applyAdjustment(std::vector<ColorRgb>& ledColors)
+{
+	TRACE_SCOPE("adjust");
+
+	if (!_adjustmentLutsValid)
+	{
+		updateLuts();
+	}
+
+	if (!_ledRangesValid)
+	{
+		updateLedRanges();
+	}
+
+	for (const LedRange& range : _ledRanges)
+	{
+		const size_t end = qMin(range.end, ledColors.size());
+		ColorAdjustment* adjustment = range.adjustment;
+		const ColorRgb* lut = range.lut;
+		const uint8_t* channelOrder = range.channelOrder;
+
+		for (size_t i=range.begin; i<end; ++i)
+		{
+			ColorRgb& color = ledColors[i];
+
+			// leds without adjustment are only reordered
+			if (adjustment != nullptr)
+			{
+				adjustColor(adjustment, lut, color);
+			}
+
+			// correct the color byte order
+			const uint8_t channels[3] = { color.red, color.green, color.blue };
+			color.red   = channels[channelOrder[0]];
+			color.green = channels[channelOrder[1]];
+			color.blue  = channels[channelOrder[2]];
+		}
+	}
+}
+
+void MultiColorAdjustment::adjustColor(ColorAdjustment* adjustment, const ColorRgb* lut, ColorRgb& color)
+{
+	// gamma and backlight are applied per channel, everything else comes from the table
+	uint8_t ored   = color.red;
+	uint8_t ogreen = color.green;
+	uint8_t oblue  = color.blue;
+
+	adjustment->_rgbTransform.transform(ored,ogreen,oblue);
+
+	const int fr = lutPosition.weight[ored];
+	const int fg = lutPosition.weight[ogreen];
+	const int fb = lutPosition.weight[oblue];
+
+	const int dr = LUT_SIZE * LUT_SIZE;
+	const int dg = LUT_SIZE;
+	const int db = 1;
+
+	const ColorRgb* c000 = lut + lutPosition.node[ored] * dr + lutPosition.node[ogreen] * dg + lutPosition.node[oblue] * db;
+	const ColorRgb* c111 = c000 + dr + dg + db;
+
+	// tetrahedral interpolation, the order of the weights selects the tetrahedron of the cube
+	const ColorRgb* c1;
+	const ColorRgb* c2;
+	int w0, w1, w2, w3;
+	if (fr >= fg)
+	{
+		if (fg >= fb)      { c1 = c000 + dr; c2 = c000 + dr + dg; w0 = 256 - fr; w1 = fr - fg; w2 = fg - fb; w3 = fb; }
+		else if (fr >= fb) { c1 = c000 + dr; c2 = c000 + dr + db; w0 = 256 - fr; w1 = fr - fb; w2 = fb - fg; w3 = fg; }
+		else               { c1 = c000 + db; c2 = c000 + dr + db; w0 = 256 - fb; w1 = fb - fr; w2 = fr - fg; w3 = fg; }
+	}
+	else
+	{
+		if (fb >= fg)      { c1 = c000 + db; c2 = c000 + dg + db; w0 = 256 - fb; w1 = fb - fg; w2 = fg - fr; w3 = fr; }
+		else if (fr >= fb) { c1 = c000 + dg; c2 = c000 + dr + dg; w0 = 256 - fg; w1 = fg - fr; w2 = fr - fb; w3 = fb; }
+		else               { c1 = c000 + dg; c2 = c000 + dg + db; w0 = 256 - fg; w1 = fg - fb; w2 = fb - fr; w3 = fr; }
+	}
+
+	color.red   = uint8_t((w0 * c000->red   + w1 * c1->red   + w2 * c2->red   + w3 * c111->red   + 128) >> 8);
+	color.green = uint8_t((w0 * c000->green + w1 * c1->green + w2 * c2->green + w3 * c111->green + 128) >> 8);
+	color.blue  = uint8_t((w0 * c000->blue  + w1 * c1->blue  + w2 * c2->blue  + w3 * c111->blue  + 128) >> 8);
+}
+
+ColorRgb MultiColorAdjustment::adjustColor(ColorAdjustment* adjustment, uint8_t ored, uint8_t ogreen, uint8_t oblue)
+{
+	uint8_t B_RGB = 0, B_CMY = 0, B_W = 0;
+	adjustment->_rgbTransform.getBrightnessComponents(B_RGB, B_CMY, B_W);
+
+	uint32_t nrng = (uint32_t) (255-ored)*(255-ogreen);
+	uint32_t rng  = (uint32_t) (ored)    *(255-ogreen);
+	uint32_t nrg  = (uint32_t) (255-ored)*(ogreen);
+	uint32_t rg   = (uint32_t) (ored)    *(ogreen);
+
+	uint8_t black   = nrng*(255-oblue)/65025;
+	uint8_t red     = rng *(255-oblue)/65025;
+	uint8_t green   = nrg *(255-oblue)/65025;
+	uint8_t blue    = nrng*(oblue)    /65025;
+	uint8_t cyan    = nrg *(oblue)    /65025;
+	uint8_t magenta = rng *(oblue)    /65025;
+	uint8_t yellow  = rg  *(255-oblue)/65025;
+	uint8_t white   = rg  *(oblue)    /65025;
+
+	uint8_t OR, OG, OB, RR, RG, RB, GR, GG, GB, BR, BG, BB;
+	uint8_t CR, CG, CB, MR, MG, MB, YR, YG, YB, WR, WG, WB;
+
+	adjustment->_rgbBlackAdjustment.apply  (black  , 255  , OR, OG, OB);
+	adjustment->_rgbRedAdjustment.apply    (red    , B_RGB, RR, RG, RB);
+	adjustment->_rgbGreenAdjustment.apply  (green  , B_RGB, GR, GG, GB);
+	adjustment->_rgbBlueAdjustment.apply   (blue   , B_RGB, BR, BG, BB);
+	adjustment->_rgbCyanAdjustment.apply   (cyan   , B_CMY, CR, CG, CB);
+	adjustment->_rgbMagentaAdjustment.apply(magenta, B_CMY, MR, MG, MB);
+	adjustment->_rgbYellowAdjustment.apply (yellow , B_CMY, YR, YG, YB);
+	adjustment->_rgbWhiteAdjustment.apply  (white  , B_W  , WR, WG, WB);
+
+	ColorRgb color;
+	color.red   = OR + RR + GR + BR + CR + MR + YR + WR;
+	color.green = OG + RG + GG + BG + CG + MG + YG + WG;
+	color.blue  = OB + RB + GB + BB + CB + MB + YB + WB;
+	return color;
 }
@@ -1,5 +1,6 @@
 // STL includes
 #include <algorithm>
+#include <functional>
 #include <limits>
 
 // qt incl
@@ -14,15 +15,33 @@
 
 const int PriorityMuxer::LOWEST_PRIORITY = std::numeric_limits<uint8_t>::max();
 
+namespace
+{
+	/// interval to re-evaluate while an effect or color with timeout is running (timeRunner())
+	const int64_t TIME_RUNNER_INTERVAL_MS = 500;
+
+	using TimeoutEntry = std::pair<int64_t, int>;
+	using TimeoutCompare = std::greater<TimeoutEntry>;
+
+	bool lessPriority(const PriorityMuxer::InputInfo& input, int priority)
+	{
+		return input.priority < priority;
+	}
+}
+
 PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	: QObject(parent)
 	, _log(Logger::getInstance("HYPERION"))
 	, _currentPriority(PriorityMuxer::LOWEST_PRIORITY)
 	, _manualSelectedPriority(256)
 	, _activeInputs()
+	, _timeoutHeap()
 	, _lowestPriorityInfo()
 	, _sourceAutoSelectEnabled(true)
 	, _updateTimer(new QTimer(this))
+	, _nextUpdate_ms(-1)
+	, _timeRunning(false)
+	, _enabled(true)
 	, _timer(new QTimer(this))
 	, _blockTimer(new QTimer(this))
 {
@@ -34,7 +53,7 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	_lowestPriorityInfo.origin         = "System";
 	_lowestPriorityInfo.owner          = "";
 
-	_activeInputs[PriorityMuxer::LOWEST_PRIORITY] = _lowestPriorityInfo;
+	_activeInputs.push_back(_lowestPriorityInfo);
 
 	// adapt to 1s interval for COLOR and EFFECT timeouts > -1
 	connect(_timer, &QTimer::timeout, this, &PriorityMuxer::timeTrigger);
@@ -45,10 +64,9 @@ PriorityMuxer::PriorityMuxer(int ledCount, QObject * parent)
 	connect(this, &PriorityMuxer::signalTimeTrigger, this, &PriorityMuxer::timeTrigger);
 	connect(this, &PriorityMuxer::activeStateChanged, this, &PriorityMuxer::prioritiesChanged);
 
-	// start muxer timer
+	// muxer timer, started for the next due timeout
 	connect(_updateTimer, &QTimer::timeout, this, &PriorityMuxer::setCurrentTime);
-	_updateTimer->setInterval(250);
-	_updateTimer->start();
+	_updateTimer->setSingleShot(true);
 }
 
 PriorityMuxer::~PriorityMuxer()
@@ -57,7 +75,16 @@ PriorityMuxer::~PriorityMuxer()
 
 void PriorityMuxer::setEnable(bool enable)
 {
-	enable ? _updateTimer->start() : _updateTimer->stop();
+	_enabled = enable;
+	if (enable)
+	{
+		scheduleUpdate();
+	}
+	else
+	{
+		_updateTimer->stop();
+		_nextUpdate_ms = -1;
+	}
 }
 
 bool PriorityMuxer::setSourceAutoSelectEnabled(bool enable, bool update)
@@ -65,7 +92,7 @@ bool PriorityMuxer::setSourceAutoSelectEnabled(bool enable, bool update)
 	if(_sourceAutoSelectEnabled != enable)
 	{
 		// on disable we need to make sure the last priority call to setPriority is still valid
-		if(!enable && !_activeInputs.contains(_manualSelectedPriority))
+		if(!enable && findInput(_manualSelectedPriority) == nullptr)
 		{
 			Warning(_log, "Can't disable auto selection, as the last manual selected priority (%d) is no longer available", _manualSelectedPriority);
 			return false;
@@ -86,7 +113,7 @@ bool PriorityMuxer::setSourceAutoSelectEnabled(bool enable, bool update)
 
 bool PriorityMuxer::setPriority(uint8_t priority)
 {
-	if(_activeInputs.contains(priority))
+	if(findInput(priority) != nullptr)
 	{
 		_manualSelectedPriority = priority;
 		// update auto select state -> update _currentPriority
@@ -98,54 +125,75 @@ bool PriorityMuxer::setPriority(uint8_t priority)
 
 void PriorityMuxer::updateLedColorsLength(int ledCount)
 {
-	for (auto infoIt = _activeInputs.begin(); infoIt != _activeInputs.end();)
+	for (InputInfo& input : _activeInputs)
 	{
-		if (infoIt->ledColors.size() >= 1)
+		if (input.ledColors.size() >= 1)
 		{
-			infoIt->ledColors.resize(ledCount, infoIt->ledColors.at(0));
+			input.ledColors.resize(ledCount, input.ledColors.at(0));
 		}
-		++infoIt;
 	}
 }
 
 QList<int> PriorityMuxer::getPriorities() const
 {
-	return _activeInputs.keys();
+	QList<int> priorities;
+	priorities.reserve(int(_activeInputs.size()));
+	for (const InputInfo& input : _activeInputs)
+	{
+		priorities.append(input.priority);
+	}
+	return priorities;
 }
 
 bool PriorityMuxer::hasPriority(int priority) const
 {
-	return (priority == PriorityMuxer::LOWEST_PRIORITY) ? true : _activeInputs.contains(priority);
+	return (priority == PriorityMuxer::LOWEST_PRIORITY) ? true : findInput(priority) != nullptr;
 }
 
-PriorityMuxer::InputInfo PriorityMuxer::getInputInfo(int priority) const
+PriorityMuxer::InputInfo* PriorityMuxer::findInput(int priority)
 {
-	auto elemIt = _activeInputs.find(priority);
-	if (elemIt == _activeInputs.end())
+	auto it = std::lower_bound(_activeInputs.begin(), _activeInputs.end(), priority, lessPriority);
+	return (it != _activeInputs.end() && it->priority == priority) ? &(*it) : nullptr;
+}
+
+const PriorityMuxer::InputInfo* PriorityMuxer::findInput(int priority) const
+{
+	auto it = std::lower_bound(_activeInputs.begin(), _activeInputs.end(), priority, lessPriority);
+	return (it != _activeInputs.end() && it->priority == priority) ? &(*it) : nullptr;
+}
+
+const PriorityMuxer::InputInfo& PriorityMuxer::getInputInfo(int priority) const
+{
+	const InputInfo* input = findInput(priority);
+	if (input == nullptr)
 	{
-		elemIt = _activeInputs.find(PriorityMuxer::LOWEST_PRIORITY);
-		if (elemIt == _activeInputs.end())
+		input = findInput(PriorityMuxer::LOWEST_PRIORITY);
+		if (input == nullptr)
 		{
 			// fallback
 			return _lowestPriorityInfo;
 		}
 	}
-	return elemIt.value();
+	return *input;
 }
 
 hyperion::Components PriorityMuxer::getComponentOfPriority(int priority) const
 {
-	return _activeInputs[priority].componentId;
+	return getInputInfo(priority).componentId;
 }
 
 void PriorityMuxer::registerInput(int priority, hyperion::Components component, const QString& origin, const QString& owner, unsigned smooth_cfg)
 {
 	// detect new registers
+	auto it = std::lower_bound(_activeInputs.begin(), _activeInputs.end(), priority, lessPriority);
 	bool newInput = false;
-	if(!_activeInputs.contains(priority))
+	if(it == _activeInputs.end() || it->priority != priority)
+	{
 		newInput = true;
+		it = _activeInputs.insert(it, InputInfo());
+	}
 
-	InputInfo& input     = _activeInputs[priority];
+	InputInfo& input     = *it;
 	input.priority       = priority;
 	input.timeoutTime_ms = newInput ? -100 : input.timeoutTime_ms;
 	input.componentId    = component;
@@ -164,7 +212,8 @@ void PriorityMuxer::registerInput(int priority, hyperion::Components component,
 
 bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColors, int64_t timeout_ms)
 {
-	if(!_activeInputs.contains(priority))
+	InputInfo* input = findInput(priority);
+	if(input == nullptr)
 	{
 		Error(_log,"setInput() used without registerInput() for priority '%d', probably the priority reached timeout",priority);
 		return false;
@@ -174,23 +223,27 @@ bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColor
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
 
-	InputInfo& input     = _activeInputs[priority];
 	// detect active <-> inactive changes
 	bool activeChange = false;
 	bool active = true;
-	if(input.timeoutTime_ms == -100 && timeout_ms != -100)
+	if(input->timeoutTime_ms == -100 && timeout_ms != -100)
 	{
 		activeChange = true;
 	}
-	else if(timeout_ms == -100 && input.timeoutTime_ms != -100)
+	else if(timeout_ms == -100 && input->timeoutTime_ms != -100)
 	{
 		active = false;
 		activeChange = true;
 	}
+	// a later timeout is picked up when the current one is due, an earlier or first timeout needs a heap entry
+	if(timeout_ms > 0 && (input->timeoutTime_ms <= 0 || timeout_ms < input->timeoutTime_ms))
+	{
+		addTimeout(timeout_ms, priority);
+	}
 	// update input
-	input.timeoutTime_ms = timeout_ms;
-	input.ledColors      = ledColors;
-	input.image.clear();
+	input->timeoutTime_ms = timeout_ms;
+	input->ledColors     = ledColors;
+	input->image.clear();
 
 	// emit active change
 	if(activeChange)
@@ -204,7 +257,8 @@ bool PriorityMuxer::setInput(int priority, const std::vector<ColorRgb>& ledColor
 
 bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, int64_t timeout_ms)
 {
-	if(!_activeInputs.contains(priority))
+	InputInfo* input = findInput(priority);
+	if(input == nullptr)
 	{
 		Error(_log,"setInputImage() used without registerInput() for priority '%d', probably the priority reached timeout",priority);
 		return false;
@@ -214,23 +268,27 @@ bool PriorityMuxer::setInputImage(int priority, const Image<ColorRgb>& image, in
 	if(timeout_ms > 0)
 		timeout_ms = QDateTime::currentMSecsSinceEpoch() + timeout_ms;
 
-	InputInfo& input     = _activeInputs[priority];
 	// detect active <-> inactive changes
 	bool activeChange = false;
 	bool active = true;
-	if(input.timeoutTime_ms == -100 && timeout_ms != -100)
+	if(input->timeoutTime_ms == -100 && timeout_ms != -100)
 	{
 		activeChange = true;
 	}
-	else if(timeout_ms == -100 && input.timeoutTime_ms != -100)
+	else if(timeout_ms == -100 && input->timeoutTime_ms != -100)
 	{
 		active = false;
 		activeChange = true;
 	}
+	// a later timeout is picked up when the current one is due, an earlier or first timeout needs a heap entry
+	if(timeout_ms > 0 && (input->timeoutTime_ms <= 0 || timeout_ms < input->timeoutTime_ms))
+	{
+		addTimeout(timeout_ms, priority);
+	}
 	// update input
-	input.timeoutTime_ms = timeout_ms;
-	input.image          = image;
-	input.ledColors.clear();
+	input->timeoutTime_ms = timeout_ms;
+	input->image         = image;
+	input->ledColors.clear();
 
 	// emit active change
 	if(activeChange)
@@ -250,8 +308,11 @@ bool PriorityMuxer::setInputInactive(quint8 priority)
 
 bool PriorityMuxer::clearInput(uint8_t priority)
 {
-	if (priority < PriorityMuxer::LOWEST_PRIORITY && _activeInputs.remove(priority))
+	auto it = std::lower_bound(_activeInputs.begin(), _activeInputs.end(), priority, lessPriority);
+	if (priority < PriorityMuxer::LOWEST_PRIORITY && it != _activeInputs.end() && it->priority == priority)
 	{
+		// an outdated timeout entry is skipped when due
+		_activeInputs.erase(it);
 		Debug(_log,"Removed source priority %d",priority);
 		// on clear success update _currentPriority
 		setCurrentTime();
@@ -267,14 +328,15 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 	if (forceClearAll)
 	{
 		_activeInputs.clear();
+		_timeoutHeap.clear();
 		_currentPriority = PriorityMuxer::LOWEST_PRIORITY;
-		_activeInputs[_currentPriority] = _lowestPriorityInfo;
+		_activeInputs.push_back(_lowestPriorityInfo);
 	}
 	else
 	{
-		for(auto key : _activeInputs.keys())
+		for(auto key : getPriorities())
 		{
-			const InputInfo info = getInputInfo(key);
+			const InputInfo& info = getInputInfo(key);
 			if ((info.componentId == hyperion::COMP_COLOR || info.componentId == hyperion::COMP_EFFECT || info.componentId == hyperion::COMP_IMAGE) && key < PriorityMuxer::LOWEST_PRIORITY-1)
 			{
 				clearInput(key);
@@ -286,36 +348,59 @@ void PriorityMuxer::clearAll(bool forceClearAll)
 void PriorityMuxer::setCurrentTime()
 {
 	const int64_t now = QDateTime::currentMSecsSinceEpoch();
-	int newPriority;
-	_activeInputs.contains(0) ? newPriority = 0 : newPriority = PriorityMuxer::LOWEST_PRIORITY;
 
-	for (auto infoIt = _activeInputs.begin(); infoIt != _activeInputs.end();)
+	// clear the inputs which reached their timeout
+	while (!_timeoutHeap.empty() && _timeoutHeap.front().first <= now)
 	{
-		if (infoIt->timeoutTime_ms > 0 && infoIt->timeoutTime_ms <= now)
+		std::pop_heap(_timeoutHeap.begin(), _timeoutHeap.end(), TimeoutCompare());
+		const int priority = _timeoutHeap.back().second;
+		_timeoutHeap.pop_back();
+
+		auto it = std::lower_bound(_activeInputs.begin(), _activeInputs.end(), priority, lessPriority);
+		if (it == _activeInputs.end() || it->priority != priority || it->timeoutTime_ms <= 0)
 		{
-			quint8 tPrio = infoIt->priority;
-			infoIt = _activeInputs.erase(infoIt);
-			Debug(_log,"Timeout clear for priority %d",tPrio);
-			emit priorityChanged(tPrio, false);
-			emit prioritiesChanged();
+			// outdated entry
+			continue;
 		}
-		else
+		if (it->timeoutTime_ms > now)
 		{
-			// timeoutTime of -100 is awaiting data (inactive); skip
-			if(infoIt->timeoutTime_ms > -100)
-				newPriority = qMin(newPriority, infoIt->priority);
+			// timeout has been extended in the meantime
+			addTimeout(it->timeoutTime_ms, priority);
+			continue;
+		}
 
-			// call timeTrigger when effect or color is running with timeout > 0, blacklist prio 255
-			if(infoIt->priority < 254 && infoIt->timeoutTime_ms > 0 && (infoIt->componentId == hyperion::COMP_EFFECT || infoIt->componentId == hyperion::COMP_COLOR  || infoIt->componentId == hyperion::COMP_IMAGE))
-				emit signalTimeTrigger(); // as signal to prevent Threading issues
+		_activeInputs.erase(it);
+		Debug(_log,"Timeout clear for priority %d",priority);
+		emit priorityChanged(priority, false);
+		emit prioritiesChanged();
+	}
 
-			++infoIt;
-		}
+	int newPriority;
+	findInput(0) != nullptr ? newPriority = 0 : newPriority = PriorityMuxer::LOWEST_PRIORITY;
+
+	_timeRunning = false;
+	for (const InputInfo& input : _activeInputs)
+	{
+		// timeoutTime of -100 is awaiting data (inactive); skip
+		if(input.timeoutTime_ms > -100)
+			newPriority = qMin(newPriority, input.priority);
+
+		// call timeTrigger when effect or color is running with timeout > 0, blacklist prio 255
+		if(input.priority < 254 && input.timeoutTime_ms > 0 && (input.componentId == hyperion::COMP_EFFECT || input.componentId == hyperion::COMP_COLOR  || input.componentId == hyperion::COMP_IMAGE))
+			_timeRunning = true;
 	}
+	if(_timeRunning)
+		emit signalTimeTrigger(); // as signal to prevent Threading issues
+
+	// wake up for the next due timeout
+	if (_updateTimer->isActive() && _nextUpdate_ms <= now)
+		_updateTimer->stop();
+	scheduleUpdate();
+
 	// eval if manual selected prio is still available
 	if(!_sourceAutoSelectEnabled)
 	{
-		if(_activeInputs.contains(_manualSelectedPriority))
+		if(findInput(_manualSelectedPriority) != nullptr)
 		{
 			newPriority = _manualSelectedPriority;
 		}
@@ -343,6 +428,50 @@ void PriorityMuxer::setCurrentTime()
 	}
 }
 
+void PriorityMuxer::addTimeout(int64_t timeoutTime_ms, int priority)
+{
+	// drop outdated entries when they pile up
+	if (_timeoutHeap.size() >= 2 * _activeInputs.size() + 16)
+	{
+		_timeoutHeap.clear();
+		for (const InputInfo& input : _activeInputs)
+		{
+			if (input.timeoutTime_ms > 0 && input.priority != priority)
+				_timeoutHeap.emplace_back(input.timeoutTime_ms, input.priority);
+		}
+		std::make_heap(_timeoutHeap.begin(), _timeoutHeap.end(), TimeoutCompare());
+	}
+
+	_timeoutHeap.emplace_back(timeoutTime_ms, priority);
+	std::push_heap(_timeoutHeap.begin(), _timeoutHeap.end(), TimeoutCompare());
+	scheduleUpdate();
+}
+
+void PriorityMuxer::scheduleUpdate()
+{
+	if (!_enabled)
+		return;
+
+	const int64_t now = QDateTime::currentMSecsSinceEpoch();
+	int64_t next = _timeRunning ? now + TIME_RUNNER_INTERVAL_MS : -1;
+	if (!_timeoutHeap.empty() && (next < 0 || _timeoutHeap.front().first < next))
+		next = _timeoutHeap.front().first;
+
+	if (next < 0)
+	{
+		_updateTimer->stop();
+		_nextUpdate_ms = -1;
+		return;
+	}
+
+	// keep an earlier wakeup, the remaining timeouts are rescheduled from there
+	if (_updateTimer->isActive() && _nextUpdate_ms <= next)
+		return;
+
+	_nextUpdate_ms = next;
+	_updateTimer->start(int(qBound<int64_t>(0, next - now, std::numeric_limits<int>::max())));
+}
+
 void PriorityMuxer::timeTrigger()
 {
 	if(_blockTimer->isActive())
@@ -11,6 +11,8 @@
 
 #include "hyperion/Hyperion.h"
 #include <utils/JsonUtils.h>
+#include <utils/FrameTiming.h>
+#include <utils/Tracer.h>
 
 //std includes
 #include <sstream>
@@ -187,8 +189,13 @@ int LedDevice::updateLeds(const std::vector<ColorRgb>& ledValues)
 		if (_latchTime_ms == 0 || elapsedTimeMs >= _latchTime_ms)
 		{
 			//std::cout << "LedDevice::updateLeds(), Elapsed time since last write (" << elapsedTimeMs << ") ms > _latchTime_ms (" << _latchTime_ms << ") ms" << std::endl;
-			retval = write(ledValues);
+			const qint64 writeStart = FrameTiming::now();
+			{
+				TRACE_SCOPE("write");
+				retval = write(ledValues);
+			}
 			_lastWriteTime = QDateTime::currentDateTime();
+			emit ledsWritten(writeStart, FrameTiming::now());
 
 			// if device requires refreshing, save Led-Values and restart the timer
 			if ( _isRefreshEnabled && _isEnabled )
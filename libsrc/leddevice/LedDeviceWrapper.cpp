@@ -13,6 +13,7 @@
 // qt
 #include <QMutexLocker>
 #include <QThread>
+#include <QAbstractEventDispatcher>
 #include <QDir>
 
 LedDeviceRegistry LedDeviceWrapper::_ledDeviceMap {};
@@ -23,6 +24,11 @@ LedDeviceWrapper::LedDeviceWrapper(Hyperion* hyperion)
 	, _hyperion(hyperion)
 	, _ledDevice(nullptr)
 	, _enabled(false)
+	, _latestBuffer(0)
+	, _readingBuffer(-1)
+	, _ledsPending(false)
+	, _deviceDispatcher(nullptr)
+	, _writingLeds(false)
 {
 	// prepare the device constructor map
 	#define REGISTER(className) LedDeviceWrapper::addToDeviceMap(QString(#className).toLower(), LedDevice##className::construct);
@@ -47,6 +53,20 @@ void LedDeviceWrapper::createLedDevice(const QJsonObject& config)
 		stopDeviceThread();
 	}
 
+	// the values of the old device are dropped, the buffers keep their capacity
+	{
+		QMutexLocker lock(&_ledBufferMutex);
+		_ledsPending = false;
+		_readingBuffer = -1;
+	}
+
+	// preallocate the buffers for the configured led count
+	const int ledCount = config["currentLedCount"].toInt(0);
+	for (std::vector<ColorRgb>& buffer : _ledBuffers)
+	{
+		buffer.reserve(static_cast<size_t>(ledCount));
+	}
+
 	// create thread and device
 	QThread* thread = new QThread(this);
 	thread->setObjectName("LedDeviceThread");
@@ -56,12 +76,28 @@ void LedDeviceWrapper::createLedDevice(const QJsonObject& config)
 	// setup thread management
 	connect(thread, &QThread::started, _ledDevice, &LedDevice::start);
 
+	// the led values are written when the event loop of the device thread wakes up or is about to block,
+	// updateLeds() wakes it up without posting an event. The dispatcher is created by the started thread.
+	connect(thread, &QThread::started, this, [=]() {
+		QAbstractEventDispatcher* dispatcher = QAbstractEventDispatcher::instance();
+		connect(dispatcher, &QAbstractEventDispatcher::awake, this, &LedDeviceWrapper::writePendingLeds, Qt::DirectConnection);
+		connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, &LedDeviceWrapper::writePendingLeds, Qt::DirectConnection);
+
+		QMutexLocker lock(&_ledBufferMutex);
+		_deviceDispatcher = dispatcher;
+		// values which were handed over before the thread started
+		if (_ledsPending)
+		{
+			_deviceDispatcher->wakeUp();
+		}
+	}, Qt::DirectConnection);
+
 	// further signals
-	connect(this, &LedDeviceWrapper::updateLeds, _ledDevice, &LedDevice::updateLeds, Qt::QueuedConnection);
 	connect(this, &LedDeviceWrapper::setEnable, _ledDevice, &LedDevice::setEnable);
 	connect(this, &LedDeviceWrapper::closeLedDevice, _ledDevice, &LedDevice::stop, Qt::BlockingQueuedConnection);
 
 	connect(_ledDevice, &LedDevice::enableStateChanged, this, &LedDeviceWrapper::handleInternalEnableState, Qt::QueuedConnection);
+	connect(_ledDevice, &LedDevice::ledsWritten, this, &LedDeviceWrapper::ledsWritten, Qt::QueuedConnection);
 
 	// start the thread
 	thread->start();
@@ -165,6 +201,59 @@ void LedDeviceWrapper::handleComponentState(hyperion::Components component, bool
 	}
 }
 
+void LedDeviceWrapper::updateLeds(const std::vector<ColorRgb>& ledValues)
+{
+	{
+		QMutexLocker lock(&_ledBufferMutex);
+
+		// the buffer the device reads stays untouched, unwritten values in the other one are replaced
+		const int buffer = (_readingBuffer == _latestBuffer) ? 1 - _latestBuffer : _latestBuffer;
+		_ledBuffers[buffer].assign(ledValues.begin(), ledValues.end());
+		_latestBuffer = buffer;
+
+		// the device did not take the previous values yet, it will find the new ones
+		if (_ledsPending)
+		{
+			return;
+		}
+		_ledsPending = true;
+
+		// thread safe and allocation free, the dispatcher is valid while the lock is held
+		if (_deviceDispatcher != nullptr)
+		{
+			_deviceDispatcher->wakeUp();
+		}
+	}
+}
+
+void LedDeviceWrapper::writePendingLeds()
+{
+	// called again by a nested event loop of the device
+	if (_writingLeds)
+	{
+		return;
+	}
+
+	int buffer;
+	{
+		QMutexLocker lock(&_ledBufferMutex);
+		if (!_ledsPending)
+		{
+			return;
+		}
+		_ledsPending = false;
+		buffer = _latestBuffer;
+		_readingBuffer = buffer;
+	}
+
+	_writingLeds = true;
+	_ledDevice->updateLeds(_ledBuffers[buffer]);
+	_writingLeds = false;
+
+	QMutexLocker lock(&_ledBufferMutex);
+	_readingBuffer = -1;
+}
+
 void LedDeviceWrapper::handleInternalEnableState(bool newState)
 {
 	_hyperion->setNewComponentState(hyperion::COMP_LEDDEVICE, newState);
@@ -180,6 +269,11 @@ void LedDeviceWrapper::stopDeviceThread()
 	// get current thread
 	QThread* oldThread = _ledDevice->thread();
 	disconnect(oldThread, nullptr, nullptr, nullptr);
+	{
+		// the dispatcher is deleted with the thread
+		QMutexLocker lock(&_ledBufferMutex);
+		_deviceDispatcher = nullptr;
+	}
 	oldThread->quit();
 	oldThread->wait();
 	delete oldThread;
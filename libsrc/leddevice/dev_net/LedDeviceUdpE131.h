@@ -104,7 +104,7 @@ public:
 	///
 	static LedDevice* construct(const QJsonObject &deviceConfig);
 
-private:
+protected:
 
 	///
 	/// @brief Initialise the device's configuration
@@ -122,6 +122,8 @@ private:
 	///
 	int write(const std::vector<ColorRgb> & ledValues) override;
 
+private:
+
 	///
 	/// @brief Generate E1.31 communication header
 	///
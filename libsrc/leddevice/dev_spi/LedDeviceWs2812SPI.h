@@ -25,7 +25,7 @@ public:
 	/// @return LedDevice constructed
 	static LedDevice* construct(const QJsonObject &deviceConfig);
 
-private:
+protected:
 
 	///
 	/// @brief Initialise the device's configuration
@@ -43,6 +43,8 @@ private:
 	///
 	int write(const std::vector<ColorRgb> & ledValues) override;
 
+private:
+
 	const int SPI_BYTES_PER_COLOUR;
 	const int SPI_FRAME_END_LATCH_BYTES;
 
@@ -7,6 +7,9 @@
 #include <QTimer>
 #include <QRgb>
 
+// utils
+#include <utils/FrameTiming.h>
+
 // TODO Remove this class if third-party apps have been migrated (eg. Hyperion Android Grabber, Windows Screen grabber etc.)
 
 ProtoClientConnection::ProtoClientConnection(QTcpSocket* socket, int timeout, QObject *parent)
@@ -177,6 +180,8 @@ void ProtoClientConnection::handleImageCommand(const proto::ImageRequest &messag
 	// create ImageRgb
 	Image<ColorRgb> image(width, height);
 	memcpy(image.memptr(), imageData.c_str(), imageData.size());
+	// the remote capture time is unknown, latency is traced from the reception
+	FrameTiming::stamp(image);
 
 	emit setGlobalInputImage(_priority, image, duration);
 
@@ -0,0 +1,148 @@
+#include <utils/AllocationCounter.h>
+
+#include <HyperionConfig.h>
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+
+// stl
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// trivially initialized and static TLS, safe to use from the allocator of any thread
+thread_local uint64_t threadAllocationCount __attribute__((tls_model("initial-exec"))) = 0;
+
+}
+
+#if defined(__GLIBC__)
+
+// glibc allows to replace malloc, the definitions of the executable are also used by the shared libraries (Qt, libstdc++).
+// A linker --wrap=malloc would miss them as it only redirects the calls linked statically.
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size)
+{
+	++threadAllocationCount;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	++threadAllocationCount;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+	++threadAllocationCount;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+	__libc_free(ptr);
+}
+
+}
+
+#else
+
+// without glibc only the global operator new is counted
+
+namespace {
+
+void* countedAlloc(std::size_t size) noexcept
+{
+	++threadAllocationCount;
+	return std::malloc(size != 0 ? size : 1);
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+	void* ptr = countedAlloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* ptr = countedAlloc(size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+#endif
+
+bool AllocationCounter::enabled()
+{
+	return true;
+}
+
+uint64_t AllocationCounter::threadAllocations()
+{
+	return threadAllocationCount;
+}
+
+#else
+
+bool AllocationCounter::enabled()
+{
+	return false;
+}
+
+uint64_t AllocationCounter::threadAllocations()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <utils/CaptureRateController.h>
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+	/// a picture is static after it's unchanged for this time, the rate is lowered from then on
+	const int64_t STATIC_DELAY_US = 1000000;
+	/// the lowest rate (2 Hz), below the timeouts which set a capture input inactive
+	const int64_t IDLE_INTERVAL_US = 500000;
+	/// the maximum number of samples compared per image
+	const unsigned MAX_SAMPLES = 16384;
+	/// the maximum number of samples compared per raw frame, checked for each captured frame
+	const unsigned MAX_LUMA_SAMPLES = 4096;
+	/// a sample is changed if a channel differs more, filters the noise of analog captures
+	const int NOISE_TOLERANCE = 16;
+	/// the picture is changed if more samples than 1/CHANGED_SAMPLES_RATIO of all samples changed
+	const unsigned CHANGED_SAMPLES_RATIO = 512;
+}
+
+CaptureRateController::CaptureRateController()
+	: _fullInterval(0)
+	, _interval(0)
+	, _staticSince(0)
+	, _idle(false)
+	, _samples()
+	, _sampledWidth(0)
+	, _sampledHeight(0)
+{
+}
+
+void CaptureRateController::setFullInterval(int64_t interval)
+{
+	_fullInterval = std::max<int64_t>(interval, 0);
+	reset();
+}
+
+void CaptureRateController::reset()
+{
+	_interval = _fullInterval;
+	_idle = false;
+	_samples.clear();
+	_sampledWidth = 0;
+	_sampledHeight = 0;
+}
+
+bool CaptureRateController::update(const Image<ColorRgb>& image, int64_t time)
+{
+	const bool changed = sampleChanged(image);
+	if (changed)
+	{
+		_staticSince = time;
+		if (!_idle)
+			_interval = _fullInterval;
+	}
+	else if (!_idle && time - _staticSince >= STATIC_DELAY_US)
+	{
+		// lower the rate step by step up to the idle interval
+		_interval = std::min(std::max<int64_t>(_interval, 1000) * 2, std::max(IDLE_INTERVAL_US, _fullInterval));
+	}
+	return changed;
+}
+
+void CaptureRateController::setIdle(bool idle)
+{
+	if (_idle != idle)
+	{
+		_idle = idle;
+		_interval = idle ? std::max(IDLE_INTERVAL_US, _fullInterval) : _fullInterval;
+
+		// the next picture is compared with the one before the idle time
+		_samples.clear();
+	}
+}
+
+bool CaptureRateController::sampleChanged(const Image<ColorRgb>& image)
+{
+	const unsigned width = image.width();
+	const unsigned height = image.height();
+	const size_t pixels = size_t(width) * height;
+	if (pixels == 0)
+		return false;
+
+	// sample a regular grid of the image, all pixels of a decimated image
+	const unsigned step = std::max(1u, unsigned(std::ceil(std::sqrt(double(pixels) / MAX_SAMPLES))));
+	const bool compare = (width == _sampledWidth && height == _sampledHeight && !_samples.empty());
+	_sampledWidth = width;
+	_sampledHeight = height;
+	if (!compare)
+		_samples.clear();
+
+	const unsigned tolerated = unsigned(((pixels / step) / step) / CHANGED_SAMPLES_RATIO);
+	unsigned changedSamples = 0;
+	size_t idx = 0;
+	for (unsigned y = 0; y < height; y += step)
+	{
+		const ColorRgb* row = image.memptr() + size_t(y) * width;
+		for (unsigned x = 0; x < width; x += step, ++idx)
+		{
+			const ColorRgb& pixel = row[x];
+			if (!compare)
+			{
+				_samples.push_back(pixel);
+				continue;
+			}
+
+			// a sample keeps its value until it changed beyond the tolerance, slow fades add up to a change
+			ColorRgb& sample = _samples[idx];
+			if (std::abs(int(pixel.red) - int(sample.red)) > NOISE_TOLERANCE
+				|| std::abs(int(pixel.green) - int(sample.green)) > NOISE_TOLERANCE
+				|| std::abs(int(pixel.blue) - int(sample.blue)) > NOISE_TOLERANCE)
+			{
+				++changedSamples;
+				sample = pixel;
+			}
+		}
+	}
+
+	// a new size is a change
+	return !compare || changedSamples > tolerated;
+}
+
+bool CaptureRateController::lumaChanged(const uint8_t* data, unsigned width, unsigned height, unsigned lineLength, unsigned pixelStride, std::vector<uint8_t>& samples)
+{
+	const size_t pixels = size_t(width) * height;
+	if (pixels == 0)
+		return false;
+
+	const unsigned step = std::max(1u, unsigned(std::ceil(std::sqrt(double(pixels) / MAX_LUMA_SAMPLES))));
+	const size_t count = size_t((width + step - 1) / step) * ((height + step - 1) / step);
+	const bool compare = (samples.size() == count);
+	if (!compare)
+		samples.resize(count);
+
+	const unsigned tolerated = unsigned(count / CHANGED_SAMPLES_RATIO);
+	unsigned changedSamples = 0;
+	uint8_t* sample = samples.data();
+	for (unsigned y = 0; y < height; y += step)
+	{
+		const uint8_t* row = data + size_t(y) * lineLength;
+		for (unsigned x = 0; x < width; x += step, ++sample)
+		{
+			const uint8_t luma = row[size_t(x) * pixelStride];
+			if (!compare)
+			{
+				*sample = luma;
+			}
+			else if (std::abs(int(luma) - int(*sample)) > NOISE_TOLERANCE)
+			{
+				++changedSamples;
+				*sample = luma;
+			}
+		}
+	}
+
+	return changedSamples > tolerated;
+}
@@ -0,0 +1,52 @@
+#include <utils/CaptureRegion.h>
+
+CaptureRegion::CaptureRegion()
+	: _mutex()
+	, _regions()
+	, _generation(0)
+{
+}
+
+void CaptureRegion::setRegion(const void* owner, const QVector<QRectF>& rects, bool fullImage)
+{
+	QMutexLocker lock(&_mutex);
+	auto it = _regions.find(owner);
+	if (it != _regions.end() && it.value().rects == rects && it.value().fullImage == fullImage)
+		return;
+
+	_regions.insert(owner, Region{ rects, fullImage });
+	_generation.fetch_add(1, std::memory_order_release);
+}
+
+void CaptureRegion::removeRegion(const void* owner)
+{
+	QMutexLocker lock(&_mutex);
+	if (_regions.remove(owner) > 0)
+		_generation.fetch_add(1, std::memory_order_release);
+}
+
+QVector<QRectF> CaptureRegion::getRegion() const
+{
+	QMutexLocker lock(&_mutex);
+	QVector<QRectF> region;
+	for (const Region& consumer : _regions)
+	{
+		// a consumer of the full image or without led areas
+		if (consumer.fullImage || consumer.rects.isEmpty())
+			return QVector<QRectF>();
+
+		region += consumer.rects;
+	}
+	return region;
+}
+
+QVector<QRectF> CaptureRegion::getLedAreas() const
+{
+	QMutexLocker lock(&_mutex);
+	QVector<QRectF> areas;
+	for (const Region& consumer : _regions)
+	{
+		areas += consumer.rects;
+	}
+	return areas;
+}
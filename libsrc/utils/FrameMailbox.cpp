@@ -0,0 +1,67 @@
+#include <utils/FrameMailbox.h>
+
+FrameMailbox::FrameMailbox(QObject* parent)
+	: QObject(parent)
+	, _frame()
+	, _full(false)
+	, _signalled(false)
+	, _generation(0)
+	, _coalesced(0)
+{
+}
+
+void FrameMailbox::post(const Frame& frame)
+{
+	quint64 generation;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		// the image and the source are shared, no pixel is copied
+		_frame = frame;
+		if (_full)
+		{
+			// the consumer has not taken the previous frame yet and is already woken up
+			++_coalesced;
+			return;
+		}
+		_full = true;
+		_signalled = true;
+		generation = _generation;
+	}
+	emit frameAvailable(generation);
+}
+
+bool FrameMailbox::take(Frame& frame, quint64 generation)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (generation != _generation)
+	{
+		// the frame of this wake up was discarded, a newer frame has its own wake up
+		return false;
+	}
+
+	_signalled = false;
+	if (!_full)
+	{
+		return false;
+	}
+
+	// the mailbox keeps the previous image of the consumer instead of a reference to the producer's image
+	frame.image.swap(_frame.image);
+	frame.source = _frame.source;
+	frame.priority = _frame.priority;
+	frame.timeout_ms = _frame.timeout_ms;
+	frame.clearEffect = _frame.clearEffect;
+	_full = false;
+	return true;
+}
+
+void FrameMailbox::discard()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_signalled)
+	{
+		++_generation;
+		_signalled = false;
+	}
+	_full = false;
+}
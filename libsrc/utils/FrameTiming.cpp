@@ -0,0 +1,21 @@
+#include <utils/FrameTiming.h>
+
+// STL includes
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+std::atomic<uint64_t> frameSequence(0);
+
+}
+
+int64_t FrameTiming::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t FrameTiming::nextSequence()
+{
+	return ++frameSequence;
+}
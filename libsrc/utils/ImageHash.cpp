@@ -0,0 +1,67 @@
+#include <utils/ImageHash.h>
+
+// STL includes
+#include <cstring>
+
+namespace {
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+inline uint64_t rotl(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline uint64_t mix(uint64_t acc, uint64_t value)
+{
+	return rotl(acc + value * PRIME2, 31) * PRIME1;
+}
+
+}
+
+uint64_t ImageHash::hash(const uint8_t* data, size_t size, uint64_t seed)
+{
+	const uint8_t* const end = data + size;
+
+	// four independent lanes keep the multipliers busy, 32 bytes per iteration
+	uint64_t acc0 = seed + PRIME1 + PRIME2;
+	uint64_t acc1 = seed + PRIME2;
+	uint64_t acc2 = seed;
+	uint64_t acc3 = seed - PRIME1;
+
+	for (; data + 32 <= end; data += 32)
+	{
+		acc0 = mix(acc0, read64(data));
+		acc1 = mix(acc1, read64(data + 8));
+		acc2 = mix(acc2, read64(data + 16));
+		acc3 = mix(acc3, read64(data + 24));
+	}
+
+	uint64_t result = rotl(acc0, 1) + rotl(acc1, 7) + rotl(acc2, 12) + rotl(acc3, 18) + uint64_t(size);
+
+	for (; data + 8 <= end; data += 8)
+	{
+		result = rotl(result ^ mix(0, read64(data)), 27) * PRIME1;
+	}
+
+	for (; data < end; ++data)
+	{
+		result = rotl(result ^ (uint64_t(*data) * PRIME2), 11) * PRIME1;
+	}
+
+	// final avalanche
+	result ^= result >> 33;
+	result *= PRIME2;
+	result ^= result >> 29;
+	result *= PRIME1;
+	result ^= result >> 32;
+	return result;
+}
@@ -1,6 +1,760 @@
 #include "utils/ImageResampler.h"
-#include <utils/ColorSys.h>
 #include <utils/Logger.h>
+#include <utils/Tracer.h>
+#include <utils/WorkerPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+#endif
+
+namespace
+{
+	/// minimum number of source pixels per band to convert a band of rows in parallel
+	const size_t PARALLEL_MIN_PIXELS = 65536;
+
+	inline uint8_t clamp(int x)
+	{
+		return (x<0) ? 0 : ((x>255) ? 255 : uint8_t(x));
+	}
+
+	/// Same as ColorSys::yuv2rgb, inlined into the per pixel loops
+	inline void yuv2rgb(uint8_t y, uint8_t u, uint8_t v, ColorRgb & rgb)
+	{
+		int c = y - 16;
+		int d = u - 128;
+		int e = v - 128;
+
+		rgb.red   = clamp((298 * c + 409 * e + 128) >> 8);
+		rgb.green = clamp((298 * c - 100 * d - 208 * e + 128) >> 8);
+		rgb.blue  = clamp((298 * c + 516 * d + 128) >> 8);
+	}
+
+#if defined(__SSE2__)
+	/// Store 8 pixels of 16 bit lanes holding 0..255 as ColorRgb
+	inline void storeRgbSse2(__m128i r, __m128i g, __m128i b, ColorRgb * rgb)
+	{
+		// saturate to 0..255 and interleave to ColorRgb
+		alignas(16) uint8_t red[16], green[16], blue[16];
+		_mm_store_si128(reinterpret_cast<__m128i *>(red),   _mm_packus_epi16(r, r));
+		_mm_store_si128(reinterpret_cast<__m128i *>(green), _mm_packus_epi16(g, g));
+		_mm_store_si128(reinterpret_cast<__m128i *>(blue),  _mm_packus_epi16(b, b));
+		for (int i = 0; i < 8; ++i)
+		{
+			rgb[i].red   = red[i];
+			rgb[i].green = green[i];
+			rgb[i].blue  = blue[i];
+		}
+	}
+
+	/// Convert 8 pixels of YUV (16 bit lanes, u and v per pixel) bit exact to yuv2rgb()
+	inline void yuv2rgbSse2(__m128i y, __m128i u, __m128i v, ColorRgb * rgb)
+	{
+		const __m128i c   = _mm_sub_epi16(y, _mm_set1_epi16(16));
+		const __m128i d   = _mm_sub_epi16(u, _mm_set1_epi16(128));
+		const __m128i e   = _mm_sub_epi16(v, _mm_set1_epi16(128));
+		const __m128i one = _mm_set1_epi16(1);
+
+		// _mm_madd_epi16 sums the 32 bit products of interleaved operand pairs
+		const __m128i kR  = _mm_setr_epi16(298,  409, 298,  409, 298,  409, 298,  409);
+		const __m128i kG  = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+		const __m128i kGE = _mm_setr_epi16(-208, 128, -208, 128, -208, 128, -208, 128);
+		const __m128i kB  = _mm_setr_epi16(298,  516, 298,  516, 298,  516, 298,  516);
+		const __m128i round = _mm_set1_epi32(128);
+
+		const __m128i ceLo = _mm_unpacklo_epi16(c, e);
+		const __m128i ceHi = _mm_unpackhi_epi16(c, e);
+		const __m128i cdLo = _mm_unpacklo_epi16(c, d);
+		const __m128i cdHi = _mm_unpackhi_epi16(c, d);
+		const __m128i e1Lo = _mm_unpacklo_epi16(e, one);
+		const __m128i e1Hi = _mm_unpackhi_epi16(e, one);
+
+		const __m128i r = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, kR), round), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, kR), round), 8));
+		const __m128i g = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, kG), _mm_madd_epi16(e1Lo, kGE)), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, kG), _mm_madd_epi16(e1Hi, kGE)), 8));
+		const __m128i b = _mm_packs_epi32(
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, kB), round), 8),
+					_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, kB), round), 8));
+
+		storeRgbSse2(r, g, b, rgb);
+	}
+
+	/// Convert 8 pixels of YUV 4:2:2, the luma is in the low (YUYV) or high (UYVY) byte of each 16 bit word
+	inline void yuv422Sse2(const uint8_t * data, bool lumaLow, ColorRgb * rgb)
+	{
+		const __m128i px   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+		const __m128i low  = _mm_and_si128(px, _mm_set1_epi16(0x00FF));
+		const __m128i high = _mm_srli_epi16(px, 8);
+		const __m128i y    = lumaLow ? low : high;
+		// u0 v0 u1 v1 u2 v2 u3 v3, each chroma pair is shared by two pixels
+		const __m128i uv   = lumaLow ? high : low;
+		const __m128i u    = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2,2,0,0)), _MM_SHUFFLE(2,2,0,0));
+		const __m128i v    = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3,3,1,1)), _MM_SHUFFLE(3,3,1,1));
+		yuv2rgbSse2(y, u, v, rgb);
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	/// Scale a YUV term to 8 bit like yuv2rgb() does, saturating narrows clamp to 0..255
+	inline uint8x8_t narrowNeon(int32x4_t lo, int32x4_t hi)
+	{
+		return vqmovun_s16(vcombine_s16(vqshrn_n_s32(lo, 8), vqshrn_n_s32(hi, 8)));
+	}
+
+	/// Convert 8 pixels of YUV (u and v per pixel) bit exact to yuv2rgb()
+	inline void yuv2rgbNeon(uint8x8_t y, uint8x8_t u, uint8x8_t v, ColorRgb * rgb)
+	{
+		const int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+		const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+		const int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+		const int32x4_t round = vdupq_n_s32(128);
+
+		const int32x4_t cLo = vaddq_s32(vmull_n_s16(vget_low_s16(c),  298), round);
+		const int32x4_t cHi = vaddq_s32(vmull_n_s16(vget_high_s16(c), 298), round);
+
+		uint8x8x3_t out;
+		out.val[0] = narrowNeon(vmlal_n_s16(cLo, vget_low_s16(e), 409), vmlal_n_s16(cHi, vget_high_s16(e), 409));
+		out.val[1] = narrowNeon(vmlal_n_s16(vmlal_n_s16(cLo, vget_low_s16(d), -100), vget_low_s16(e), -208),
+					vmlal_n_s16(vmlal_n_s16(cHi, vget_high_s16(d), -100), vget_high_s16(e), -208));
+		out.val[2] = narrowNeon(vmlal_n_s16(cLo, vget_low_s16(d), 516), vmlal_n_s16(cHi, vget_high_s16(d), 516));
+		vst3_u8(reinterpret_cast<uint8_t *>(rgb), out);
+	}
+
+	/// Convert 8 pixels of YUV 4:2:2, the luma is the first (YUYV) or second (UYVY) byte of each pixel
+	inline void yuv422Neon(const uint8_t * data, bool lumaFirst, ColorRgb * rgb)
+	{
+		const uint8x8x2_t px = vld2_u8(data);
+		const uint8x8_t y  = lumaFirst ? px.val[0] : px.val[1];
+		// u0 v0 u1 v1 u2 v2 u3 v3, each chroma pair is shared by two pixels
+		const uint8x8_t uv = lumaFirst ? px.val[1] : px.val[0];
+		const uint8x8x2_t chroma = vuzp_u8(uv, uv);
+		yuv2rgbNeon(y, vzip_u8(chroma.val[0], chroma.val[0]).val[0], vzip_u8(chroma.val[1], chroma.val[1]).val[0], rgb);
+	}
+#endif
+
+	///
+	/// The source frame, the area after cropping and the decimation
+	///
+	struct SourceArea
+	{
+		const uint8_t * data;
+		int lineLength;
+		int height;
+		int xBegin;
+		int xEnd;
+		int yBegin;
+		int yEnd;
+		int horizontalDecimation;
+		int verticalDecimation;
+	};
+
+	///
+	/// Pixel formats, line() returns the source line(s) of a row, read() converts a single source pixel,
+	/// convertRow() converts consecutive pixels with SIMD and returns the count of converted pixels
+	/// (the rest is done by read()). sum() adds the components of a pixel to a block sum, store()
+	/// converts the block average; YUV is averaged before the conversion.
+	///
+	struct PackedFormat
+	{
+		using Line = const uint8_t *;
+
+		static Line line(const SourceArea & area, int ySource)
+		{
+			return area.data + area.lineLength * ySource;
+		}
+	};
+
+	struct RgbStore : PackedFormat
+	{
+		static void store(const uint32_t * avg, ColorRgb & rgb)
+		{
+			rgb.red   = uint8_t(avg[0]);
+			rgb.green = uint8_t(avg[1]);
+			rgb.blue  = uint8_t(avg[2]);
+		}
+	};
+
+	struct YUYV : PackedFormat
+	{
+		static void read(const uint8_t * line, int xSource, ColorRgb & rgb)
+		{
+			int index = xSource << 1;
+			uint8_t y = line[index];
+			uint8_t u = ((xSource&1) == 0) ? line[index+1] : line[index-1];
+			uint8_t v = ((xSource&1) == 0) ? line[index+3] : line[index+1];
+			yuv2rgb(y, u, v, rgb);
+		}
+
+		static void sum(const uint8_t * line, int xSource, uint32_t * acc)
+		{
+			int index = xSource << 1;
+			acc[0] += line[index];
+			acc[1] += ((xSource&1) == 0) ? line[index+1] : line[index-1];
+			acc[2] += ((xSource&1) == 0) ? line[index+3] : line[index+1];
+		}
+
+		static void store(const uint32_t * avg, ColorRgb & rgb)
+		{
+			yuv2rgb(uint8_t(avg[0]), uint8_t(avg[1]), uint8_t(avg[2]), rgb);
+		}
+
+		static int convertRow(const uint8_t * line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+			// chroma pairs start at even pixels
+			if ((xSource&1) != 0)
+				return 0;
+			for (const uint8_t * data = line + (xSource << 1); done + 8 <= count; done += 8, data += 16)
+			{
+#if defined(__SSE2__)
+				yuv422Sse2(data, true, rgb + done);
+#else
+				yuv422Neon(data, true, rgb + done);
+#endif
+			}
+#endif
+			return done;
+		}
+	};
+
+	struct UYVY : PackedFormat
+	{
+		static void read(const uint8_t * line, int xSource, ColorRgb & rgb)
+		{
+			int index = xSource << 1;
+			uint8_t y = line[index+1];
+			uint8_t u = ((xSource&1) == 0) ? line[index  ] : line[index-2];
+			uint8_t v = ((xSource&1) == 0) ? line[index+2] : line[index  ];
+			yuv2rgb(y, u, v, rgb);
+		}
+
+		static void sum(const uint8_t * line, int xSource, uint32_t * acc)
+		{
+			int index = xSource << 1;
+			acc[0] += line[index+1];
+			acc[1] += ((xSource&1) == 0) ? line[index  ] : line[index-2];
+			acc[2] += ((xSource&1) == 0) ? line[index+2] : line[index  ];
+		}
+
+		static void store(const uint32_t * avg, ColorRgb & rgb)
+		{
+			yuv2rgb(uint8_t(avg[0]), uint8_t(avg[1]), uint8_t(avg[2]), rgb);
+		}
+
+		static int convertRow(const uint8_t * line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+			// chroma pairs start at even pixels
+			if ((xSource&1) != 0)
+				return 0;
+			for (const uint8_t * data = line + (xSource << 1); done + 8 <= count; done += 8, data += 16)
+			{
+#if defined(__SSE2__)
+				yuv422Sse2(data, false, rgb + done);
+#else
+				yuv422Neon(data, false, rgb + done);
+#endif
+			}
+#endif
+			return done;
+		}
+	};
+
+	struct BGR16 : RgbStore
+	{
+		static void read(const uint8_t * line, int xSource, ColorRgb & rgb)
+		{
+			int index = xSource << 1;
+			rgb.blue  = (line[index] & 0x1f) << 3;
+			rgb.green = (((line[index+1] & 0x7) << 3) | (line[index] & 0xE0) >> 5) << 2;
+			rgb.red   = (line[index+1] & 0xF8);
+		}
+
+		static void sum(const uint8_t * line, int xSource, uint32_t * acc)
+		{
+			ColorRgb rgb;
+			read(line, xSource, rgb);
+			acc[0] += rgb.red;
+			acc[1] += rgb.green;
+			acc[2] += rgb.blue;
+		}
+
+		static int convertRow(const uint8_t * line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+			const uint8_t * data = line + (xSource << 1);
+#if defined(__SSE2__)
+			for (; done + 8 <= count; done += 8, data += 16)
+			{
+				// little endian 5:6:5 words, blue in the low bits
+				const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+				const __m128i b  = _mm_slli_epi16(_mm_and_si128(px, _mm_set1_epi16(0x1f)), 3);
+				const __m128i g  = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(px, 5), _mm_set1_epi16(0x3f)), 2);
+				const __m128i r  = _mm_slli_epi16(_mm_srli_epi16(px, 11), 3);
+				storeRgbSse2(r, g, b, rgb + done);
+			}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+			for (; done + 8 <= count; done += 8, data += 16)
+			{
+				// little endian 5:6:5 words, blue in the low bits
+				const uint16x8_t px = vreinterpretq_u16_u8(vld1q_u8(data));
+				uint8x8x3_t out;
+				out.val[0] = vmovn_u16(vshlq_n_u16(vshrq_n_u16(px, 11), 3));
+				out.val[1] = vmovn_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(px, 5), vdupq_n_u16(0x3f)), 2));
+				out.val[2] = vmovn_u16(vshlq_n_u16(vandq_u16(px, vdupq_n_u16(0x1f)), 3));
+				vst3_u8(reinterpret_cast<uint8_t *>(rgb + done), out);
+			}
+#endif
+			(void)data;
+			return done;
+		}
+	};
+
+	template <bool Bgr>
+	struct Rgb24 : RgbStore
+	{
+		static void read(const uint8_t * line, int xSource, ColorRgb & rgb)
+		{
+			int index = (xSource << 1) + xSource;
+			rgb.red   = line[index + (Bgr ? 2 : 0)];
+			rgb.green = line[index+1];
+			rgb.blue  = line[index + (Bgr ? 0 : 2)];
+		}
+
+		static void sum(const uint8_t * line, int xSource, uint32_t * acc)
+		{
+			int index = (xSource << 1) + xSource;
+			acc[0] += line[index + (Bgr ? 2 : 0)];
+			acc[1] += line[index+1];
+			acc[2] += line[index + (Bgr ? 0 : 2)];
+		}
+
+		static int convertRow(const uint8_t * line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+			const uint8_t * data = line + (xSource << 1) + xSource;
+			// the source has the byte order of ColorRgb
+			if (!Bgr)
+			{
+				memcpy(rgb, data, size_t(count) * sizeof(ColorRgb));
+				return count;
+			}
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+			for (; done + 16 <= count; done += 16, data += 48)
+			{
+				const uint8x16x3_t px = vld3q_u8(data);
+				uint8x16x3_t out;
+				out.val[0] = px.val[2];
+				out.val[1] = px.val[1];
+				out.val[2] = px.val[0];
+				vst3q_u8(reinterpret_cast<uint8_t *>(rgb + done), out);
+			}
+#elif defined(__SSE2__)
+			// swap the first and the third byte of the 5 pixels in bytes 0..14, byte 15 is the first byte of the
+			// next pixel and is rewritten by the next step. The 16 byte load and store need a 6th pixel.
+			const __m128i keep  = _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, -1);
+			const __m128i first = _mm_setr_epi8(-1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, 0);
+			const __m128i third = _mm_setr_epi8(0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0);
+			for (; done + 6 <= count; done += 5, data += 15)
+			{
+				const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+				const __m128i out = _mm_or_si128(_mm_and_si128(px, keep),
+							_mm_or_si128(_mm_and_si128(_mm_srli_si128(px, 2), first), _mm_and_si128(_mm_slli_si128(px, 2), third)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + done), out);
+			}
+#endif
+			(void)data;
+			return done;
+		}
+	};
+
+	template <bool Bgr>
+	struct Rgb32 : RgbStore
+	{
+		static void read(const uint8_t * line, int xSource, ColorRgb & rgb)
+		{
+			int index = xSource << 2;
+			rgb.red   = line[index + (Bgr ? 2 : 0)];
+			rgb.green = line[index+1];
+			rgb.blue  = line[index + (Bgr ? 0 : 2)];
+		}
+
+		static void sum(const uint8_t * line, int xSource, uint32_t * acc)
+		{
+			int index = xSource << 2;
+			acc[0] += line[index + (Bgr ? 2 : 0)];
+			acc[1] += line[index+1];
+			acc[2] += line[index + (Bgr ? 0 : 2)];
+		}
+
+		static int convertRow(const uint8_t * line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+			for (const uint8_t * data = line + (xSource << 2); done + 16 <= count; done += 16, data += 64)
+			{
+				const uint8x16x4_t px = vld4q_u8(data);
+				uint8x16x3_t out;
+				out.val[0] = px.val[Bgr ? 2 : 0];
+				out.val[1] = px.val[1];
+				out.val[2] = px.val[Bgr ? 0 : 2];
+				vst3q_u8(reinterpret_cast<uint8_t *>(rgb + done), out);
+			}
+#elif defined(__SSE2__)
+			const __m128i mask = _mm_set1_epi32(0xFF);
+			for (const uint8_t * data = line + (xSource << 2); done + 8 <= count; done += 8, data += 32)
+			{
+				// little endian 32 bit pixels, the first byte in the low bits
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+				const __m128i c0 = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+				const __m128i c1 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask), _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+				const __m128i c2 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask), _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+				storeRgbSse2(Bgr ? c2 : c0, c1, Bgr ? c0 : c2, rgb + done);
+			}
+#else
+			(void)line; (void)xSource; (void)count; (void)rgb;
+#endif
+			return done;
+		}
+	};
+
+	///
+	/// Planar YUV 4:2:0, a full resolution luma plane followed by the chroma of each 2x2 block. The chroma
+	/// is semi-planar (NV12/NV21: one plane with interleaved u/v) or planar (I420/YV12: u and v planes
+	/// with half the line length). Only the luma and chroma samples of the converted pixels are read.
+	///
+	template <bool SemiPlanar, bool VFirst>
+	struct Yuv420
+	{
+		struct Line
+		{
+			const uint8_t * y;
+			const uint8_t * u;
+			const uint8_t * v;
+		};
+
+		/// distance of the chroma samples of neighboring 2x2 blocks
+		static const int chromaStep = SemiPlanar ? 2 : 1;
+
+		static Line line(const SourceArea & area, int ySource)
+		{
+			const uint8_t * luma   = area.data + area.lineLength * ySource;
+			const uint8_t * chroma = area.data + area.lineLength * area.height;
+			const int chromaRow    = ySource >> 1;
+			if (SemiPlanar)
+			{
+				chroma += area.lineLength * chromaRow;
+				return VFirst ? Line{ luma, chroma + 1, chroma } : Line{ luma, chroma, chroma + 1 };
+			}
+
+			const int chromaLineLength = area.lineLength >> 1;
+			const uint8_t * first  = chroma + chromaLineLength * chromaRow;
+			const uint8_t * second = chroma + chromaLineLength * ((area.height + 1) >> 1) + chromaLineLength * chromaRow;
+			return VFirst ? Line{ luma, second, first } : Line{ luma, first, second };
+		}
+
+		static void read(const Line & line, int xSource, ColorRgb & rgb)
+		{
+			const int chroma = (xSource >> 1) * chromaStep;
+			yuv2rgb(line.y[xSource], line.u[chroma], line.v[chroma], rgb);
+		}
+
+		static void sum(const Line & line, int xSource, uint32_t * acc)
+		{
+			const int chroma = (xSource >> 1) * chromaStep;
+			acc[0] += line.y[xSource];
+			acc[1] += line.u[chroma];
+			acc[2] += line.v[chroma];
+		}
+
+		static void store(const uint32_t * avg, ColorRgb & rgb)
+		{
+			yuv2rgb(uint8_t(avg[0]), uint8_t(avg[1]), uint8_t(avg[2]), rgb);
+		}
+
+		static int convertRow(const Line & line, int xSource, int count, ColorRgb * rgb)
+		{
+			int done = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+			// chroma is shared by pixel pairs starting at even pixels
+			if ((xSource&1) != 0)
+				return 0;
+			for (; done + 8 <= count; done += 8)
+			{
+				const int x = xSource + done;
+				const int chroma = (x >> 1) * chromaStep;
+#if defined(__SSE2__)
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(line.y + x)), zero);
+				__m128i u, v;
+				if (SemiPlanar)
+				{
+					// 4 interleaved chroma pairs, one pair per 16 bit word
+					const __m128i uv = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(VFirst ? line.v + chroma : line.u + chroma));
+					const __m128i low  = _mm_and_si128(uv, _mm_set1_epi16(0x00FF));
+					const __m128i high = _mm_srli_epi16(uv, 8);
+					u = VFirst ? high : low;
+					v = VFirst ? low : high;
+				}
+				else
+				{
+					int32_t u4, v4;
+					memcpy(&u4, line.u + chroma, 4);
+					memcpy(&v4, line.v + chroma, 4);
+					u = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+					v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+				}
+				// every chroma sample is used by two pixels
+				yuv2rgbSse2(y, _mm_unpacklo_epi16(u, u), _mm_unpacklo_epi16(v, v), rgb + done);
+#else
+				const uint8x8_t y = vld1_u8(line.y + x);
+				uint8x8_t u, v;
+				if (SemiPlanar)
+				{
+					const uint8x8x2_t uv = vuzp_u8(vld1_u8(VFirst ? line.v + chroma : line.u + chroma), vdup_n_u8(0));
+					u = uv.val[VFirst ? 1 : 0];
+					v = uv.val[VFirst ? 0 : 1];
+				}
+				else
+				{
+					uint32_t u4, v4;
+					memcpy(&u4, line.u + chroma, 4);
+					memcpy(&v4, line.v + chroma, 4);
+					u = vreinterpret_u8_u32(vdup_n_u32(u4));
+					v = vreinterpret_u8_u32(vdup_n_u32(v4));
+				}
+				// every chroma sample is used by two pixels
+				yuv2rgbNeon(y, vzip_u8(u, u).val[0], vzip_u8(v, v).val[0], rgb + done);
+#endif
+			}
+#endif
+			return done;
+		}
+	};
+
+	using NV12 = Yuv420<true, false>;
+	using NV21 = Yuv420<true, true>;
+	using I420 = Yuv420<false, false>;
+	using YV12 = Yuv420<false, true>;
+
+	using RGB24 = Rgb24<false>;
+	using BGR24 = Rgb24<true>;
+	using RGB32 = Rgb32<false>;
+	using BGR32 = Rgb32<true>;
+
+	///
+	/// The output columns to convert, see ImageResampler::_regionRows. Without rows all columns are converted.
+	///
+	struct OutputColumns
+	{
+		const int * rows;
+		const int * columns;
+		/// the span of a full row
+		int row[2];
+
+		/// Get the spans of a row as pairs of begin and end column
+		int spans(int yDest, const int * & span) const
+		{
+			if (rows == nullptr)
+			{
+				span = row;
+				return 1;
+			}
+			span = columns + 2 * rows[yDest];
+			return rows[yDest+1] - rows[yDest];
+		}
+
+		/// Blacken the columns of a row which are not converted
+		void clearGaps(int yDest, ColorRgb * rgb) const
+		{
+			if (rows == nullptr)
+				return;
+
+			const int * span;
+			const int spanCount = spans(yDest, span);
+			int x = 0;
+			for (int i = 0; i < spanCount; ++i, span += 2)
+			{
+				memset(rgb + x, 0, size_t(span[0] - x) * sizeof(ColorRgb));
+				x = span[1];
+			}
+			memset(rgb + x, 0, size_t(row[1] - x) * sizeof(ColorRgb));
+		}
+	};
+
+	///
+	/// Resample with the center pixel of each decimation block. Without horizontal decimation the source
+	/// pixels of a line are consecutive and converted by SIMD where available.
+	///
+	template <class Format>
+	void resamplePoint(const SourceArea & area, const OutputColumns & output, Image<ColorRgb> & outputImage)
+	{
+		const int outputWidth  = int(outputImage.width());
+		const int outputHeight = int(outputImage.height());
+		const int xStart = area.xBegin + (area.horizontalDecimation >> 1);
+		const int yStart = area.yBegin + (area.verticalDecimation >> 1);
+		ColorRgb * outputPixels = outputImage.memptr();
+
+		// rows are independent, bands of rows are converted in parallel
+		WorkerPool::getInstance()->parallelFor(size_t(outputHeight), std::max<size_t>(1, PARALLEL_MIN_PIXELS / std::max(outputWidth, 1)),
+			[&](size_t begin, size_t end)
+			{
+				ColorRgb * rgb = outputPixels + begin * outputWidth;
+				for (int yDest = int(begin), ySource = yStart + yDest * area.verticalDecimation; yDest < int(end); ySource += area.verticalDecimation, ++yDest, rgb += outputWidth)
+				{
+					output.clearGaps(yDest, rgb);
+
+					const int * span;
+					const int spanCount = output.spans(yDest, span);
+					if (spanCount == 0)
+						continue;
+
+					const typename Format::Line line = Format::line(area, ySource);
+					for (int i = 0; i < spanCount; ++i, span += 2)
+					{
+						const int xBegin = span[0];
+						const int xEnd   = span[1];
+						int xDest = xBegin + ((area.horizontalDecimation == 1) ? Format::convertRow(line, xStart + xBegin, xEnd - xBegin, rgb + xBegin) : 0);
+						for (int xSource = xStart + xDest * area.horizontalDecimation; xDest < xEnd; xSource += area.horizontalDecimation, ++xDest)
+						{
+							Format::read(line, xSource, rgb[xDest]);
+						}
+					}
+				}
+			});
+	}
+
+	///
+	/// Resample with the average of each decimation block, the block of the last column/row may be cut by
+	/// the crop border. The source lines are read in order, the component sums of a destination row are kept in acc.
+	///
+	template <class Format>
+	void resampleAverage(const SourceArea & area, const OutputColumns & output, Image<ColorRgb> & outputImage)
+	{
+		const int horizontalDecimation = area.horizontalDecimation;
+		const int verticalDecimation   = area.verticalDecimation;
+		const int outputWidth  = int(outputImage.width());
+		const int outputHeight = int(outputImage.height());
+		ColorRgb * outputPixels = outputImage.memptr();
+
+		// rows are independent, bands of rows are converted in parallel
+		const size_t blockPixels = size_t(std::max(outputWidth, 1)) * horizontalDecimation * verticalDecimation;
+		WorkerPool::getInstance()->parallelFor(size_t(outputHeight), std::max<size_t>(1, PARALLEL_MIN_PIXELS / blockPixels),
+			[&](size_t begin, size_t end)
+			{
+				std::vector<uint32_t> acc(size_t(outputWidth) * 3);
+				ColorRgb * rgb = outputPixels + begin * outputWidth;
+
+				for (int yDest = int(begin), yBlock = area.yBegin + yDest * verticalDecimation; yDest < int(end); yBlock += verticalDecimation, ++yDest, rgb += outputWidth)
+				{
+					output.clearGaps(yDest, rgb);
+
+					const int * rowSpan;
+					const int spanCount = output.spans(yDest, rowSpan);
+					if (spanCount == 0)
+						continue;
+
+					std::fill(acc.begin(), acc.end(), 0);
+					const int blockHeight = std::min(verticalDecimation, area.yEnd - yBlock);
+
+					for (int ySource = yBlock; ySource < yBlock + blockHeight; ++ySource)
+					{
+						const typename Format::Line line = Format::line(area, ySource);
+						const int * span = rowSpan;
+						for (int i = 0; i < spanCount; ++i, span += 2)
+						{
+							uint32_t * sum = acc.data() + 3 * span[0];
+							for (int xDest = span[0], xBlock = area.xBegin + xDest * horizontalDecimation; xDest < span[1]; xBlock += horizontalDecimation, ++xDest, sum += 3)
+							{
+								const int xBlockEnd = std::min(xBlock + horizontalDecimation, area.xEnd);
+								for (int xSource = xBlock; xSource < xBlockEnd; ++xSource)
+								{
+									Format::sum(line, xSource, sum);
+								}
+							}
+						}
+					}
+
+					const int * span = rowSpan;
+					for (int i = 0; i < spanCount; ++i, span += 2)
+					{
+						const uint32_t * sum = acc.data() + 3 * span[0];
+						for (int xDest = span[0], xBlock = area.xBegin + xDest * horizontalDecimation; xDest < span[1]; xBlock += horizontalDecimation, ++xDest, sum += 3)
+						{
+							const uint32_t count = uint32_t(blockHeight * (std::min(xBlock + horizontalDecimation, area.xEnd) - xBlock));
+							const uint32_t avg[3] = { (sum[0] + count/2) / count, (sum[1] + count/2) / count, (sum[2] + count/2) / count };
+							Format::store(avg, rgb[xDest]);
+						}
+					}
+				}
+			});
+	}
+
+	template <class Format>
+	void resample(const SourceArea & area, const OutputColumns & output, bool average, Image<ColorRgb> & outputImage)
+	{
+		if (int(outputImage.width()) <= 0 || int(outputImage.height()) <= 0)
+			return;
+
+		if (average && (area.horizontalDecimation > 1 || area.verticalDecimation > 1))
+			resampleAverage<Format>(area, output, outputImage);
+		else
+			resamplePoint<Format>(area, output, outputImage);
+	}
+
+	///
+	/// Rasterize the relative areas to the spans of output columns per row. The areas are grown by a pixel
+	/// to cover the rounding of the led areas (see ImageToLedsMap), overlapping spans are merged.
+	///
+	void rasterizeRegion(const QVector<QRectF> & region, int width, int height, std::vector<int> & rows, std::vector<int> & columns)
+	{
+		rows.assign(size_t(height) + 1, 0);
+		columns.clear();
+
+		std::vector<std::pair<int,int>> spans;
+		for (int y = 0; y < height; ++y)
+		{
+			rows[size_t(y)] = int(columns.size() / 2);
+
+			spans.clear();
+			for (const QRectF & rect : region)
+			{
+				if (y < int(std::floor(rect.top() * height)) - 1 || y >= int(std::ceil(rect.bottom() * height)) + 1)
+					continue;
+
+				const int xBegin = std::max(0, int(std::floor(rect.left() * width)) - 1);
+				const int xEnd   = std::min(width, int(std::ceil(rect.right() * width)) + 1);
+				if (xBegin < xEnd)
+					spans.emplace_back(xBegin, xEnd);
+			}
+
+			std::sort(spans.begin(), spans.end());
+			for (const auto & span : spans)
+			{
+				if (!columns.empty() && rows[size_t(y)] < int(columns.size() / 2) && span.first <= columns.back())
+				{
+					columns.back() = std::max(columns.back(), span.second);
+				}
+				else
+				{
+					columns.push_back(span.first);
+					columns.push_back(span.second);
+				}
+			}
+		}
+		rows[size_t(height)] = int(columns.size() / 2);
+	}
+}
 
 ImageResampler::ImageResampler()
 	: _horizontalDecimation(1)
@@ -10,6 +764,12 @@ ImageResampler::ImageResampler()
 	, _cropTop(0)
 	, _cropBottom(0)
 	, _videoMode(VideoMode::VIDEO_2D)
+	, _averageDecimation(false)
+	, _region()
+	, _regionWidth(0)
+	, _regionHeight(0)
+	, _regionRows()
+	, _regionColumns()
 {
 }
 
@@ -40,10 +800,53 @@ void ImageResampler::setVideoMode(VideoMode mode)
 	_videoMode = mode;
 }
 
-void ImageResampler::processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> &outputImage) const
+void ImageResampler::setAverageDecimation(bool enable)
+{
+	_averageDecimation = enable;
+}
+
+void ImageResampler::setRegion(const QVector<QRectF>& region)
+{
+	if (region == _region)
+		return;
+
+	_region = region;
+	// rasterized again with the next image
+	_regionWidth = 0;
+	_regionHeight = 0;
+}
+
+int ImageResampler::getSourceScale() const
+{
+	if (_horizontalDecimation < 1 || _verticalDecimation < 1)
+		return 1;
+
+	int scale = 8;
+	while (scale > 1 && ((_horizontalDecimation % scale) != 0 || (_verticalDecimation % scale) != 0))
+	{
+		scale >>= 1;
+	}
+	return scale;
+}
+
+bool ImageResampler::isPassThrough(int sourceScale) const
+{
+	return _videoMode == VideoMode::VIDEO_2D
+			&& _cropLeft == 0 && _cropRight == 0 && _cropTop == 0 && _cropBottom == 0
+			&& _horizontalDecimation == sourceScale && _verticalDecimation == sourceScale;
+}
+
+void ImageResampler::processImage(const uint8_t * data, int width, int height, int lineLength, PixelFormat pixelFormat, Image<ColorRgb> &outputImage, int sourceScale) const
 {
-	int cropRight  = _cropRight;
-	int cropBottom = _cropBottom;
+	TRACE_SCOPE("resample");
+
+	// the cropping and decimation of a downscaled frame
+	const int horizontalDecimation = std::max(1, _horizontalDecimation / sourceScale);
+	const int verticalDecimation   = std::max(1, _verticalDecimation / sourceScale);
+	const int cropLeft = (_cropLeft + sourceScale/2) / sourceScale;
+	const int cropTop  = (_cropTop  + sourceScale/2) / sourceScale;
+	int cropRight  = (_cropRight  + sourceScale/2) / sourceScale;
+	int cropBottom = (_cropBottom + sourceScale/2) / sourceScale;
 
 	// handle 3D mode
 	switch (_videoMode)
@@ -59,79 +862,68 @@ void ImageResampler::processImage(const uint8_t * data, int width, int height, i
 	}
 
 	// calculate the output size
-	int outputWidth = (width - _cropLeft - cropRight - (_horizontalDecimation >> 1) + _horizontalDecimation - 1) / _horizontalDecimation;
-	int outputHeight = (height - _cropTop - cropBottom - (_verticalDecimation >> 1) + _verticalDecimation - 1) / _verticalDecimation;
+	int outputWidth = (width - cropLeft - cropRight - (horizontalDecimation >> 1) + horizontalDecimation - 1) / horizontalDecimation;
+	int outputHeight = (height - cropTop - cropBottom - (verticalDecimation >> 1) + verticalDecimation - 1) / verticalDecimation;
 
 	outputImage.resize(outputWidth, outputHeight);
 
-	for (int yDest = 0, ySource = _cropTop + (_verticalDecimation >> 1); yDest < outputHeight; ySource += _verticalDecimation, ++yDest)
-	{
-		int yOffset = lineLength * ySource;
+	const SourceArea area = { data, lineLength, height, cropLeft, width - cropRight, cropTop, height - cropBottom, horizontalDecimation, verticalDecimation };
 
-		for (int xDest = 0, xSource = _cropLeft + (_horizontalDecimation >> 1); xDest < outputWidth; xSource += _horizontalDecimation, ++xDest)
+	OutputColumns output = { nullptr, nullptr, { 0, outputWidth } };
+	if (!_region.isEmpty() && outputWidth > 0 && outputHeight > 0)
+	{
+		if (_regionWidth != outputWidth || _regionHeight != outputHeight)
 		{
-			ColorRgb & rgb = outputImage(xDest, yDest);
+			rasterizeRegion(_region, outputWidth, outputHeight, _regionRows, _regionColumns);
+			_regionWidth = outputWidth;
+			_regionHeight = outputHeight;
+		}
+		// the pixels outside of the region are blackened row by row
+		output.rows = _regionRows.data();
+		output.columns = _regionColumns.data();
+	}
 
-			switch (pixelFormat)
-			{
-				case PixelFormat::UYVY:
-				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index+1];
-					uint8_t u = ((xSource&1) == 0) ? data[index  ] : data[index-2];
-					uint8_t v = ((xSource&1) == 0) ? data[index+2] : data[index  ];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-				}
-				break;
-				case PixelFormat::YUYV:
-				{
-					int index = yOffset + (xSource << 1);
-					uint8_t y = data[index];
-					uint8_t u = ((xSource&1) == 0) ? data[index+1] : data[index-1];
-					uint8_t v = ((xSource&1) == 0) ? data[index+3] : data[index+1];
-					ColorSys::yuv2rgb(y, u, v, rgb.red, rgb.green, rgb.blue);
-				}
-				break;
-				case PixelFormat::BGR16:
-				{
-					int index = yOffset + (xSource << 1);
-					rgb.blue  = (data[index] & 0x1f) << 3;
-					rgb.green = (((data[index+1] & 0x7) << 3) | (data[index] & 0xE0) >> 5) << 2;
-					rgb.red   = (data[index+1] & 0xF8);
-				}
-				break;
-				case PixelFormat::BGR24:
-				{
-					int index = yOffset + (xSource << 1) + xSource;
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
-				}
-				break;
-				case PixelFormat::RGB32:
-				{
-					int index = yOffset + (xSource << 2);
-					rgb.red   = data[index  ];
-					rgb.green = data[index+1];
-					rgb.blue  = data[index+2];
-				}
-				break;
-				case PixelFormat::BGR32:
-				{
-					int index = yOffset + (xSource << 2);
-					rgb.blue  = data[index  ];
-					rgb.green = data[index+1];
-					rgb.red   = data[index+2];
-				}
-				break;
+	switch (pixelFormat)
+	{
+		case PixelFormat::UYVY:
+			resample<UYVY>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::YUYV:
+			resample<YUYV>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::BGR16:
+			resample<BGR16>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::BGR24:
+			resample<BGR24>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::RGB24:
+			resample<RGB24>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::NV12:
+			resample<NV12>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::NV21:
+			resample<NV21>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::I420:
+			resample<I420>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::YV12:
+			resample<YV12>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::RGB32:
+			resample<RGB32>(area, output, _averageDecimation, outputImage);
+		break;
+		case PixelFormat::BGR32:
+			resample<BGR32>(area, output, _averageDecimation, outputImage);
+		break;
 #ifdef HAVE_JPEG_DECODER
-				case PixelFormat::MJPEG:
-				break;
+		case PixelFormat::MJPEG:
+		break;
 #endif
-				case PixelFormat::NO_CHANGE:
-					Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
-				break;
-			}
-		}
+		case PixelFormat::NO_CHANGE:
+			Error(Logger::getInstance("ImageResampler"), "Invalid pixel format given");
+		break;
 	}
 }
@@ -0,0 +1,110 @@
+#include <utils/LatencyHistogram.h>
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+
+// QT includes
+#include <QJsonArray>
+
+namespace {
+
+/// upper bound of bucket idx in microseconds, the last bucket is open
+inline int64_t bucketLimit(int idx)
+{
+	if (idx < LatencyHistogram::LINEAR_BUCKET_COUNT)
+		return int64_t(idx + 1) * 1000;
+
+	return int64_t(LatencyHistogram::LINEAR_BUCKET_COUNT) * 1000 << (idx - LatencyHistogram::LINEAR_BUCKET_COUNT + 1);
+}
+
+inline int bucketIndex(int64_t latency)
+{
+	if (latency < int64_t(LatencyHistogram::LINEAR_BUCKET_COUNT) * 1000)
+		return int(latency / 1000);
+
+	int idx = LatencyHistogram::LINEAR_BUCKET_COUNT;
+	while (idx < LatencyHistogram::BUCKET_COUNT - 1 && latency >= bucketLimit(idx))
+		++idx;
+	return idx;
+}
+
+inline double toMs(int64_t latency)
+{
+	return std::round(latency / 10.0) / 100.0;
+}
+
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::add(int64_t latency)
+{
+	if (latency < 0)
+		return;
+
+	++_buckets[bucketIndex(latency)];
+	_min = (_count == 0) ? latency : std::min(_min, latency);
+	_max = std::max(_max, latency);
+	_sum += latency;
+	++_count;
+}
+
+void LatencyHistogram::reset()
+{
+	std::fill(_buckets, _buckets + BUCKET_COUNT, 0);
+	_count = 0;
+	_sum = 0;
+	_min = 0;
+	_max = 0;
+}
+
+int64_t LatencyHistogram::percentile(double percent) const
+{
+	const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(_count * percent / 100.0)));
+	uint64_t seen = 0;
+	for (int idx = 0; idx < BUCKET_COUNT - 1; ++idx)
+	{
+		if (seen + _buckets[idx] >= rank)
+		{
+			// assume the samples are spread evenly over the bucket
+			const int64_t lower = (idx == 0) ? 0 : bucketLimit(idx - 1);
+			const double fraction = (double(rank - seen) - 0.5) / double(_buckets[idx]);
+			const int64_t latency = lower + int64_t(std::round(fraction * double(bucketLimit(idx) - lower)));
+			return std::max(_min, std::min(latency, _max));
+		}
+		seen += _buckets[idx];
+	}
+	return _max;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+	QJsonArray buckets;
+	for (int idx = 0; idx < BUCKET_COUNT; ++idx)
+	{
+		if (_buckets[idx] == 0)
+			continue;
+
+		QJsonObject bucket;
+		// the open last bucket has no upper bound
+		if (idx < BUCKET_COUNT - 1)
+			bucket["lt_ms"] = qint64(bucketLimit(idx) / 1000);
+		bucket["count"] = qint64(_buckets[idx]);
+		buckets.append(bucket);
+	}
+
+	QJsonObject result;
+	result["count"] = qint64(_count);
+	result["min_ms"] = toMs(_min);
+	result["max_ms"] = toMs(_max);
+	result["avg_ms"] = (_count > 0) ? toMs(_sum / int64_t(_count)) : 0.0;
+	result["p50_ms"] = (_count > 0) ? toMs(percentile(50)) : 0.0;
+	result["p95_ms"] = (_count > 0) ? toMs(percentile(95)) : 0.0;
+	result["p99_ms"] = (_count > 0) ? toMs(percentile(99)) : 0.0;
+	result["buckets"] = buckets;
+	return result;
+}
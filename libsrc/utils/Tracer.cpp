@@ -0,0 +1,224 @@
+#include <utils/Tracer.h>
+
+// stl
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// qt
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+namespace {
+
+struct Event
+{
+	const char* name;
+	int64_t start;
+	int64_t duration;
+};
+
+///
+/// Slot of the ring buffer, the fields are atomic as the export reads them while the owner thread overwrites them
+///
+struct EventSlot
+{
+	std::atomic<const char*> name { nullptr };
+	std::atomic<int64_t> start { 0 };
+	std::atomic<int64_t> duration { 0 };
+};
+
+///
+/// Ring buffer of a single thread. Only the owner thread writes events, the export reads them
+/// concurrently and drops the events which might have been overwritten while copying (seqlock).
+///
+struct ThreadBuffer
+{
+	int tid = 0;
+	QString threadName;
+	/// number of events written, the next event goes to head % RING_BUFFER_SIZE
+	std::atomic<uint64_t> head { 0 };
+	/// number of events the owner thread started to write, ahead of head while an event is written
+	std::atomic<uint64_t> writing { 0 };
+	/// events before this index belong to a previous recording
+	std::atomic<uint64_t> begin { 0 };
+	/// the thread exited, the buffer can be taken over by a new thread
+	bool retired = false;
+	EventSlot events[Tracer::RING_BUFFER_SIZE];
+};
+
+///
+/// The buffers outlive all threads (intentionally never freed), threads might exit during shutdown
+///
+struct TracerState
+{
+	std::mutex mutex;
+	std::vector<ThreadBuffer*> buffers;
+	int nextTid = 1;
+};
+
+TracerState& state()
+{
+	static TracerState* tracerState = new TracerState();
+	return *tracerState;
+}
+
+///
+/// Hands the buffer of an exiting thread back for reuse
+///
+struct ThreadSlot
+{
+	ThreadBuffer* buffer = nullptr;
+
+	~ThreadSlot()
+	{
+		if (buffer != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(state().mutex);
+			buffer->retired = true;
+		}
+	}
+};
+
+thread_local ThreadSlot threadSlot;
+
+ThreadBuffer* acquireBuffer()
+{
+	TracerState& tracer = state();
+	std::lock_guard<std::mutex> lock(tracer.mutex);
+
+	ThreadBuffer* buffer = nullptr;
+	for (ThreadBuffer* candidate : tracer.buffers)
+	{
+		if (candidate->retired)
+		{
+			buffer = candidate;
+			break;
+		}
+	}
+
+	if (buffer == nullptr)
+	{
+		buffer = new ThreadBuffer();
+		tracer.buffers.push_back(buffer);
+	}
+
+	buffer->tid = tracer.nextTid++;
+	buffer->threadName = QThread::currentThread()->objectName();
+	if (buffer->threadName.isEmpty())
+	{
+		buffer->threadName = QString("Thread %1").arg(buffer->tid);
+	}
+	buffer->head.store(0, std::memory_order_relaxed);
+	buffer->writing.store(0, std::memory_order_relaxed);
+	buffer->begin.store(0, std::memory_order_relaxed);
+	buffer->retired = false;
+	return buffer;
+}
+
+}
+
+std::atomic<bool> Tracer::_enabled(false);
+
+void Tracer::setEnabled(bool enable)
+{
+	TracerState& tracer = state();
+	std::lock_guard<std::mutex> lock(tracer.mutex);
+
+	if (enable && !_enabled.load())
+	{
+		// a new recording starts with empty buffers
+		for (ThreadBuffer* buffer : tracer.buffers)
+		{
+			buffer->begin.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+		}
+	}
+	_enabled.store(enable);
+}
+
+void Tracer::record(const char* name, int64_t start, int64_t duration)
+{
+	ThreadBuffer* buffer = threadSlot.buffer;
+	if (buffer == nullptr)
+	{
+		buffer = threadSlot.buffer = acquireBuffer();
+	}
+
+	// announce the overwrite of the oldest event before the slot is touched
+	const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	buffer->writing.store(head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	EventSlot& event = buffer->events[head % RING_BUFFER_SIZE];
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.duration.store(duration, std::memory_order_relaxed);
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+QJsonDocument Tracer::exportChromeTrace()
+{
+	const qint64 pid = QCoreApplication::applicationPid();
+	QJsonArray traceEvents;
+	std::vector<Event> events;
+
+	TracerState& tracer = state();
+	std::lock_guard<std::mutex> lock(tracer.mutex);
+
+	for (ThreadBuffer* buffer : tracer.buffers)
+	{
+		const uint64_t head = buffer->head.load(std::memory_order_acquire);
+		const uint64_t oldest = (head > RING_BUFFER_SIZE) ? head - RING_BUFFER_SIZE : 0;
+		uint64_t first = std::max(buffer->begin.load(std::memory_order_acquire), oldest);
+
+		events.clear();
+		for (uint64_t idx = first; idx < head; ++idx)
+		{
+			const EventSlot& slot = buffer->events[idx % RING_BUFFER_SIZE];
+			events.push_back({ slot.name.load(std::memory_order_relaxed),
+							   slot.start.load(std::memory_order_relaxed),
+							   slot.duration.load(std::memory_order_relaxed) });
+		}
+
+		// the owner thread kept writing, drop the events it might have overwritten meanwhile including the one in progress
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t writing = buffer->writing.load(std::memory_order_relaxed);
+		const uint64_t overwritten = (writing > RING_BUFFER_SIZE) ? writing - RING_BUFFER_SIZE : 0;
+		const size_t skip = size_t(std::min<uint64_t>(overwritten > first ? overwritten - first : 0, events.size()));
+
+		if (events.size() == skip)
+		{
+			continue;
+		}
+
+		QJsonObject threadName;
+		threadName["name"] = "thread_name";
+		threadName["ph"] = "M";
+		threadName["pid"] = pid;
+		threadName["tid"] = buffer->tid;
+		threadName["args"] = QJsonObject { { "name", buffer->threadName } };
+		traceEvents.append(threadName);
+
+		for (size_t idx = skip; idx < events.size(); ++idx)
+		{
+			QJsonObject traceEvent;
+			traceEvent["name"] = events[idx].name;
+			traceEvent["cat"] = "hyperion";
+			traceEvent["ph"] = "X";
+			traceEvent["ts"] = qint64(events[idx].start);
+			traceEvent["dur"] = qint64(events[idx].duration);
+			traceEvent["pid"] = pid;
+			traceEvent["tid"] = buffer->tid;
+			traceEvents.append(traceEvent);
+		}
+	}
+
+	QJsonObject trace;
+	trace["traceEvents"] = traceEvents;
+	trace["displayTimeUnit"] = "ms";
+	return QJsonDocument(trace);
+}
@@ -0,0 +1,76 @@
+#include <utils/WorkerPool.h>
+
+// qt
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+
+namespace {
+
+/// Set for threads of the pool, nested parallelFor() calls run serial to avoid starving the pool
+thread_local bool isWorkerThread = false;
+
+class ChunkTask : public QRunnable
+{
+public:
+	ChunkTask(const std::function<void(size_t, size_t)>& task, size_t begin, size_t end, QSemaphore& done)
+		: _task(task)
+		, _begin(begin)
+		, _end(end)
+		, _done(done)
+	{
+		setAutoDelete(true);
+	}
+
+	void run() override
+	{
+		isWorkerThread = true;
+		_task(_begin, _end);
+		_done.release();
+	}
+
+private:
+	const std::function<void(size_t, size_t)>& _task;
+	const size_t _begin;
+	const size_t _end;
+	QSemaphore& _done;
+};
+
+}
+
+WorkerPool::WorkerPool()
+	: _concurrency(qMax(QThread::idealThreadCount(), 1))
+	, _pool()
+{
+	// the calling thread takes a share of the work as well
+	_pool.setMaxThreadCount(qMax(_concurrency - 1, 1));
+	_pool.setExpiryTimeout(-1);
+}
+
+void WorkerPool::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& task)
+{
+	const size_t maxChunks = (minChunkSize > 0) ? count / minChunkSize : count;
+	const size_t chunks = qMin(maxChunks, size_t(concurrency()));
+
+	if (chunks < 2 || isWorkerThread)
+	{
+		task(0, count);
+		return;
+	}
+
+	QSemaphore done;
+	const size_t chunkSize = count / chunks;
+	const size_t remainder = count % chunks;
+
+	// distribute the remainder over the first chunks, the calling thread processes the first one
+	size_t begin = chunkSize + (remainder > 0 ? 1 : 0);
+	for (size_t chunk = 1; chunk < chunks; ++chunk)
+	{
+		const size_t end = begin + chunkSize + (chunk < remainder ? 1 : 0);
+		_pool.start(new ChunkTask(task, begin, end, done));
+		begin = end;
+	}
+
+	task(0, chunkSize + (remainder > 0 ? 1 : 0));
+	done.acquire(int(chunks - 1));
+}
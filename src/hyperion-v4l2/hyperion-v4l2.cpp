@@ -55,7 +55,7 @@ int main(int argc, char** argv)
 		Option             & argDevice              = parser.add<Option>       ('d', "device", "The device to use, can be /dev/video0 [default: %1 (auto detected)]", "auto");
 		IntOption          & argInput               = parser.add<IntOption>    ('i', "input",  "The device input [default: %1]", "0");
 		SwitchOption<VideoStandard> & argVideoStandard= parser.add<SwitchOption<VideoStandard>>('v', "video-standard", "The used video standard. Valid values are PAL, NTSC, SECAM or no-change. [default: %1]", "no-change");
-		SwitchOption<PixelFormat> & argPixelFormat    = parser.add<SwitchOption<PixelFormat>>  (0x0, "pixel-format", "The use pixel format. Valid values are YUYV, UYVY, RGB32, MJPEG or no-change. [default: %1]", "no-change");
+		SwitchOption<PixelFormat> & argPixelFormat    = parser.add<SwitchOption<PixelFormat>>  (0x0, "pixel-format", "The use pixel format. Valid values are YUYV, UYVY, RGB32, NV12, NV21, I420, YV12, MJPEG or no-change. [default: %1]", "no-change");
 		IntOption          & argFps                 = parser.add<IntOption>    ('f', "framerate",  "Capture frame rate [default: %1]", "15", 1, 25);
 		IntOption          & argWidth               = parser.add<IntOption>    (0x0, "width",      "Width of the captured image [default: %1]", "160", 160);
 		IntOption          & argHeight              = parser.add<IntOption>    (0x0, "height",     "Height of the captured image [default: %1]", "160", 160);
@@ -94,6 +94,10 @@ int main(int argc, char** argv)
 		argPixelFormat.addSwitch("yuyv", PixelFormat::YUYV);
 		argPixelFormat.addSwitch("uyvy", PixelFormat::UYVY);
 		argPixelFormat.addSwitch("rgb32", PixelFormat::RGB32);
+		argPixelFormat.addSwitch("nv12", PixelFormat::NV12);
+		argPixelFormat.addSwitch("nv21", PixelFormat::NV21);
+		argPixelFormat.addSwitch("i420", PixelFormat::I420);
+		argPixelFormat.addSwitch("yv12", PixelFormat::YV12);
 #ifdef HAVE_JPEG
 		argPixelFormat.addSwitch("mjpeg", PixelFormat::MJPEG);
 #endif
@@ -9,6 +9,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QJsonArray>
 #include <QPair>
 #include <cstdint>
 #include <limits>
@@ -74,6 +75,7 @@ HyperionDaemon::HyperionDaemon(const QString rootPath, QObject *parent, bool log
 		, _sslWebserver(nullptr)
 		, _jsonServer(nullptr)
 		, _v4l2Grabber(nullptr)
+		, _v4l2AdditionalGrabbers()
 		, _dispmanx(nullptr)
 		, _x11Grabber(nullptr)
 		, _xcbGrabber(nullptr)
@@ -244,9 +246,14 @@ void HyperionDaemon::freeObjects()
 	delete _fbGrabber;
 	delete _osxGrabber;
 	delete _qtGrabber;
-	delete _v4l2Grabber;
+	destroyGrabberV4L2(_v4l2Grabber);
+	for (V4L2Wrapper* grabber : _v4l2AdditionalGrabbers)
+	{
+		destroyGrabberV4L2(grabber);
+	}
 
 	_v4l2Grabber = nullptr;
+	_v4l2AdditionalGrabbers.clear();
 	_bonjourBrowserWrapper = nullptr;
 	_amlGrabber = nullptr;
 	_dispmanx = nullptr;
@@ -345,6 +352,7 @@ void HyperionDaemon::handleSettingsUpdate(settings::type settingsType, const QJs
 
 		_grabber_ge2d_mode = grabberConfig["ge2d_mode"].toInt(0);
 		_grabber_device = grabberConfig["amlogic_grabber"].toString("amvideocap0");
+		_grabber_adaptiveRate = grabberConfig["adaptiveRate"].toBool(true);
 
 #ifdef ENABLE_OSX
 		QString type = "osx";
@@ -534,53 +542,136 @@ void HyperionDaemon::handleSettingsUpdate(settings::type settingsType, const QJs
 		}
 #endif
 
-		if (_v4l2Grabber != nullptr)
-			return;
-
 #ifdef ENABLE_V4L2
-		_v4l2Grabber = new V4L2Wrapper(
-				grabberConfig["device"].toString("auto"),
-				grabberConfig["width"].toInt(0),
-				grabberConfig["height"].toInt(0),
-				grabberConfig["fps"].toInt(15),
-				grabberConfig["input"].toInt(-1),
-				parseVideoStandard(grabberConfig["standard"].toString("no-change")),
-				parsePixelFormat(grabberConfig["pixelFormat"].toString("no-change")),
-				grabberConfig["sizeDecimation"].toInt(8));
-
-		_v4l2Grabber->setSignalThreshold(
-				grabberConfig["redSignalThreshold"].toDouble(0.0) / 100.0,
-				grabberConfig["greenSignalThreshold"].toDouble(0.0) / 100.0,
-				grabberConfig["blueSignalThreshold"].toDouble(0.0) / 100.0);
-		_v4l2Grabber->setCropping(
-				grabberConfig["cropLeft"].toInt(0),
-				grabberConfig["cropRight"].toInt(0),
-				grabberConfig["cropTop"].toInt(0),
-				grabberConfig["cropBottom"].toInt(0));
-
-		_v4l2Grabber->setCecDetectionEnable(grabberConfig["cecDetection"].toBool(true));
-		_v4l2Grabber->setSignalDetectionEnable(grabberConfig["signalDetection"].toBool(true));
-		_v4l2Grabber->setSignalDetectionOffset(
-				grabberConfig["sDHOffsetMin"].toDouble(0.25),
-				grabberConfig["sDVOffsetMin"].toDouble(0.25),
-				grabberConfig["sDHOffsetMax"].toDouble(0.75),
-				grabberConfig["sDVOffsetMax"].toDouble(0.75));
-		Debug(_log, "V4L2 grabber created");
-
-		// connect to HyperionDaemon signal
-		connect(this, &HyperionDaemon::videoMode, _v4l2Grabber, &V4L2Wrapper::setVideoMode);
-		connect(this, &HyperionDaemon::settingsChanged, _v4l2Grabber, &V4L2Wrapper::handleSettingsUpdate);
+		if (_v4l2Grabber == nullptr)
+		{
+			_v4l2Grabber = createGrabberV4L2(grabberConfig, false);
+		}
+
+		// the additional devices are captured concurrently, a device is identified by the path it resolves to
+		QStringList additionalDevices;
+		QStringList devicePaths(_v4l2Grabber->getDevicePath(grabberConfig["device"].toString("auto")));
+		for (const QJsonValue& item : grabberConfig["additionalDevices"].toArray())
+		{
+			const QString device = item.toObject()["device"].toString();
+			const QString devicePath = _v4l2Grabber->getDevicePath(device);
+			if (device.isEmpty() || device == "auto" || devicePaths.contains(devicePath))
+			{
+				Error(_log, "Additional v4l2 device '%s' ignored, a unique device path is required", QSTRING_CSTR(device));
+				continue;
+			}
+			additionalDevices << device;
+			devicePaths << devicePath;
+		}
+
+		for (const QString& device : _v4l2AdditionalGrabbers.keys())
+		{
+			if (!additionalDevices.contains(device))
+			{
+				destroyGrabberV4L2(_v4l2AdditionalGrabbers.take(device));
+				Debug(_log, "Additional V4L2 grabber %s removed", QSTRING_CSTR(device));
+			}
+		}
+
+		for (const QString& device : additionalDevices)
+		{
+			if (!_v4l2AdditionalGrabbers.contains(device))
+			{
+				_v4l2AdditionalGrabbers.insert(device, createGrabberV4L2(V4L2Wrapper::additionalDeviceConfig(grabberConfig, device), true));
+			}
+		}
 #else
 		Error(_log, "The v4l2 grabber can not be instantiated, because it has been left out from the build");
 #endif
 	}
 }
 
+V4L2Wrapper* HyperionDaemon::createGrabberV4L2(const QJsonObject& grabberConfig, bool additionalDevice)
+{
+#ifdef ENABLE_V4L2
+	V4L2Wrapper* grabber = new V4L2Wrapper(
+			grabberConfig["device"].toString("auto"),
+			grabberConfig["width"].toInt(0),
+			grabberConfig["height"].toInt(0),
+			grabberConfig["fps"].toInt(15),
+			grabberConfig["input"].toInt(-1),
+			parseVideoStandard(grabberConfig["standard"].toString("no-change")),
+			parsePixelFormat(grabberConfig["pixelFormat"].toString("no-change")),
+			grabberConfig["sizeDecimation"].toInt(8),
+			additionalDevice);
+
+	grabber->setAverageDecimation(grabberConfig["averageDecimation"].toBool(false));
+	grabber->setAutoFormat(grabberConfig["autoFormat"].toBool(false));
+	grabber->setAdaptiveRate(grabberConfig["adaptiveRate"].toBool(true));
+
+	grabber->setSignalThreshold(
+			grabberConfig["redSignalThreshold"].toDouble(0.0) / 100.0,
+			grabberConfig["greenSignalThreshold"].toDouble(0.0) / 100.0,
+			grabberConfig["blueSignalThreshold"].toDouble(0.0) / 100.0);
+	grabber->setCropping(
+			grabberConfig["cropLeft"].toInt(0),
+			grabberConfig["cropRight"].toInt(0),
+			grabberConfig["cropTop"].toInt(0),
+			grabberConfig["cropBottom"].toInt(0));
+
+	grabber->setCecDetectionEnable(grabberConfig["cecDetection"].toBool(true));
+	grabber->setSignalDetectionEnable(grabberConfig["signalDetection"].toBool(true));
+	grabber->setSignalDetectionOffset(
+			grabberConfig["sDHOffsetMin"].toDouble(0.25),
+			grabberConfig["sDVOffsetMin"].toDouble(0.25),
+			grabberConfig["sDHOffsetMax"].toDouble(0.75),
+			grabberConfig["sDVOffsetMax"].toDouble(0.75));
+
+	// start if an instance requested the device already
+	grabber->tryStart();
+
+	// each device processes its frames in its own thread
+	QThread* thread = new QThread(this);
+	thread->setObjectName("V4L2Thread");
+	grabber->moveToProcessingThread(thread);
+	thread->start();
+	Debug(_log, "V4L2 grabber created for device %s", QSTRING_CSTR(grabberConfig["device"].toString("auto")));
+
+	// connect to HyperionDaemon signal
+	connect(this, &HyperionDaemon::videoMode, grabber, &V4L2Wrapper::setVideoMode);
+	connect(this, &HyperionDaemon::settingsChanged, grabber, &V4L2Wrapper::handleSettingsUpdate);
+#ifdef ENABLE_CEC
+	if (_cecHandler)
+		connect(_cecHandler, &CECHandler::cecEvent, grabber, &V4L2Wrapper::handleCecEvent);
+#endif
+	return grabber;
+#else
+	Q_UNUSED(grabberConfig);
+	Q_UNUSED(additionalDevice);
+	Error(_log, "The v4l2 grabber can not be instantiated, because it has been left out from the build");
+	return nullptr;
+#endif
+}
+
+void HyperionDaemon::destroyGrabberV4L2(V4L2Wrapper* grabber)
+{
+#ifdef ENABLE_V4L2
+	if (grabber == nullptr)
+		return;
+
+	// stop the capture in the processing thread before it's finished
+	QThread* thread = grabber->thread();
+	QMetaObject::invokeMethod(grabber, "stop", Qt::BlockingQueuedConnection);
+	thread->quit();
+	thread->wait();
+	delete grabber;
+	delete thread;
+#else
+	Q_UNUSED(grabber);
+#endif
+}
+
 void HyperionDaemon::createGrabberDispmanx()
 {
 #ifdef ENABLE_DISPMANX
 	_dispmanx = new DispmanxWrapper(_grabber_width, _grabber_height, _grabber_frequency);
 	_dispmanx->setCropping(_grabber_cropLeft, _grabber_cropRight, _grabber_cropTop, _grabber_cropBottom);
+	_dispmanx->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _dispmanx, &DispmanxWrapper::setVideoMode);
@@ -597,6 +688,7 @@ void HyperionDaemon::createGrabberAmlogic()
 #ifdef ENABLE_AMLOGIC
 	_amlGrabber = new AmlogicWrapper(_grabber_width, _grabber_height);
 	_amlGrabber->setCropping(_grabber_cropLeft, _grabber_cropRight, _grabber_cropTop, _grabber_cropBottom);
+	_amlGrabber->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _amlGrabber, &AmlogicWrapper::setVideoMode);
@@ -616,6 +708,7 @@ void HyperionDaemon::createGrabberX11(const QJsonObject &grabberConfig)
 			grabberConfig["pixelDecimation"].toInt(8),
 			_grabber_frequency);
 	_x11Grabber->setCropping(_grabber_cropLeft, _grabber_cropRight, _grabber_cropTop, _grabber_cropBottom);
+	_x11Grabber->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _x11Grabber, &X11Wrapper::setVideoMode);
@@ -635,6 +728,7 @@ void HyperionDaemon::createGrabberXcb(const QJsonObject &grabberConfig)
 			grabberConfig["pixelDecimation"].toInt(8),
 			_grabber_frequency);
 	_xcbGrabber->setCropping(_grabber_cropLeft, _grabber_cropRight, _grabber_cropTop, _grabber_cropBottom);
+	_xcbGrabber->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _xcbGrabber, &XcbWrapper::setVideoMode);
@@ -654,6 +748,7 @@ void HyperionDaemon::createGrabberQt(const QJsonObject &grabberConfig)
 			grabberConfig["pixelDecimation"].toInt(8),
 			grabberConfig["display"].toInt(0),
 			_grabber_frequency);
+	_qtGrabber->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _qtGrabber, &QtWrapper::setVideoMode);
@@ -673,6 +768,7 @@ void HyperionDaemon::createGrabberFramebuffer(const QJsonObject &grabberConfig)
 			grabberConfig["device"].toString("/dev/fb0"),
 			_grabber_width, _grabber_height, _grabber_frequency);
 	_fbGrabber->setCropping(_grabber_cropLeft, _grabber_cropRight, _grabber_cropTop, _grabber_cropBottom);
+	_fbGrabber->setAdaptiveRate(_grabber_adaptiveRate);
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _fbGrabber, &FramebufferWrapper::setVideoMode);
 	connect(this, &HyperionDaemon::settingsChanged, _fbGrabber, &FramebufferWrapper::handleSettingsUpdate);
@@ -690,6 +786,7 @@ void HyperionDaemon::createGrabberOsx(const QJsonObject &grabberConfig)
 	_osxGrabber = new OsxWrapper(
 			grabberConfig["display"].toInt(0),
 			_grabber_width, _grabber_height, _grabber_frequency);
+	_osxGrabber->setAdaptiveRate(_grabber_adaptiveRate);
 
 	// connect to HyperionDaemon signal
 	connect(this, &HyperionDaemon::videoMode, _osxGrabber, &OsxWrapper::setVideoMode);
@@ -711,11 +808,7 @@ void HyperionDaemon::createCecHandler()
 	_cecHandler->moveToThread(thread);
 	thread->start();
 
-	connect(_cecHandler, &CECHandler::cecEvent, [&] (CECEvent event) {
-		if (_v4l2Grabber)
-			_v4l2Grabber->handleCecEvent(event);
-	});
-
+	// the v4l2 grabbers connect to the cec events when created
 	Info(_log, "CEC handler created");
 #else
 	Error(_log, "The CEC handler can not be instantiated, because it has been left out from the build");
@@ -3,6 +3,7 @@
 #include <QApplication>
 #include <QObject>
 #include <QJsonObject>
+#include <QMap>
 
 #ifdef ENABLE_DISPMANX
 	#include <grabber/DispmanxWrapper.h>
@@ -152,6 +153,8 @@ private:
 	void createGrabberX11(const QJsonObject & grabberConfig);
 	void createGrabberXcb(const QJsonObject & grabberConfig);
 	void createGrabberQt(const QJsonObject & grabberConfig);
+	V4L2Wrapper* createGrabberV4L2(const QJsonObject & grabberConfig, bool additionalDevice);
+	void destroyGrabberV4L2(V4L2Wrapper* grabber);
 	void createCecHandler();
 
 	Logger*                    _log;
@@ -164,6 +167,7 @@ private:
 	WebServer*                 _sslWebserver;
 	JsonServer*                _jsonServer;
 	V4L2Wrapper*               _v4l2Grabber;
+	QMap<QString, V4L2Wrapper*> _v4l2AdditionalGrabbers;
 	DispmanxWrapper*           _dispmanx;
 	X11Wrapper*                _x11Grabber;
 	XcbWrapper*                _xcbGrabber;
@@ -185,6 +189,7 @@ private:
 	unsigned                   _grabber_cropBottom;
 	int                        _grabber_ge2d_mode;
 	QString                    _grabber_device;
+	bool                       _grabber_adaptiveRate;
 
 	QString                    _prevType;
 
@@ -0,0 +1,467 @@
+
+// STL includes
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Qt includes
+#include <QRectF>
+#include <QVector>
+
+// Utils includes
+#include <utils/ColorRgb.h>
+#include <utils/ColorSys.h>
+#include <utils/Image.h>
+#include <utils/ImageResampler.h>
+#include <utils/PixelFormat.h>
+
+struct FormatInfo
+{
+	PixelFormat format;
+	/// bytes per pixel of a packed format, 0 for the planar YUV 4:2:0 formats
+	int bytesPerPixel;
+	const char* name;
+};
+
+const FormatInfo FORMATS[] = {
+	{ PixelFormat::YUYV,  2, "YUYV" },
+	{ PixelFormat::UYVY,  2, "UYVY" },
+	{ PixelFormat::BGR16, 2, "BGR16" },
+	{ PixelFormat::BGR24, 3, "BGR24" },
+	{ PixelFormat::RGB24, 3, "RGB24" },
+	{ PixelFormat::RGB32, 4, "RGB32" },
+	{ PixelFormat::BGR32, 4, "BGR32" },
+	{ PixelFormat::NV12,  0, "NV12" },
+	{ PixelFormat::NV21,  0, "NV21" },
+	{ PixelFormat::I420,  0, "I420" },
+	{ PixelFormat::YV12,  0, "YV12" },
+};
+
+///
+/// True for the YUV formats, their components are y, u and v
+///
+bool isYuv(PixelFormat format)
+{
+	switch (format)
+	{
+	case PixelFormat::YUYV:
+	case PixelFormat::UYVY:
+	case PixelFormat::NV12:
+	case PixelFormat::NV21:
+	case PixelFormat::I420:
+	case PixelFormat::YV12:
+		return true;
+	default:
+		return false;
+	}
+}
+
+///
+/// Read the components of a single source pixel, y, u, v of the YUV formats and red, green, blue of the RGB formats
+///
+void readComponents(const std::vector<uint8_t>& data, int height, int lineLength, PixelFormat format, int x, int y, uint8_t* components)
+{
+	const int line = lineLength * y;
+	switch (format)
+	{
+	case PixelFormat::YUYV:
+	{
+		const int index = line + (x << 1);
+		components[0] = data[index];
+		components[1] = ((x&1) == 0) ? data[index+1] : data[index-1];
+		components[2] = ((x&1) == 0) ? data[index+3] : data[index+1];
+		break;
+	}
+	case PixelFormat::UYVY:
+	{
+		const int index = line + (x << 1);
+		components[0] = data[index+1];
+		components[1] = ((x&1) == 0) ? data[index  ] : data[index-2];
+		components[2] = ((x&1) == 0) ? data[index+2] : data[index  ];
+		break;
+	}
+	case PixelFormat::BGR16:
+	{
+		const int index = line + (x << 1);
+		components[0] = uint8_t(data[index+1] & 0xF8);
+		components[1] = uint8_t((((data[index+1] & 0x7) << 3) | (data[index] & 0xE0) >> 5) << 2);
+		components[2] = uint8_t((data[index] & 0x1f) << 3);
+		break;
+	}
+	case PixelFormat::BGR24:
+	case PixelFormat::RGB24:
+	{
+		const int index = line + x * 3;
+		const bool bgr = format == PixelFormat::BGR24;
+		components[0] = data[index + (bgr ? 2 : 0)];
+		components[1] = data[index + 1];
+		components[2] = data[index + (bgr ? 0 : 2)];
+		break;
+	}
+	case PixelFormat::RGB32:
+	case PixelFormat::BGR32:
+	{
+		const int index = line + x * 4;
+		const bool bgr = format == PixelFormat::BGR32;
+		components[0] = data[index + (bgr ? 2 : 0)];
+		components[1] = data[index + 1];
+		components[2] = data[index + (bgr ? 0 : 2)];
+		break;
+	}
+	case PixelFormat::NV12:
+	case PixelFormat::NV21:
+	{
+		const int chroma = lineLength * height + lineLength * (y >> 1) + ((x >> 1) << 1);
+		const bool vFirst = format == PixelFormat::NV21;
+		components[0] = data[line + x];
+		components[1] = data[chroma + (vFirst ? 1 : 0)];
+		components[2] = data[chroma + (vFirst ? 0 : 1)];
+		break;
+	}
+	case PixelFormat::I420:
+	case PixelFormat::YV12:
+	{
+		const int chromaLineLength = lineLength >> 1;
+		const int first  = lineLength * height + chromaLineLength * (y >> 1) + (x >> 1);
+		const int second = first + chromaLineLength * ((height + 1) >> 1);
+		const bool vFirst = format == PixelFormat::YV12;
+		components[0] = data[line + x];
+		components[1] = data[vFirst ? second : first];
+		components[2] = data[vFirst ? first : second];
+		break;
+	}
+	default:
+		components[0] = components[1] = components[2] = 0;
+		break;
+	}
+}
+
+///
+/// Convert the components of a pixel or of a block average to RGB
+///
+ColorRgb toRgb(PixelFormat format, const uint8_t* components)
+{
+	ColorRgb rgb;
+	if (isYuv(format))
+	{
+		ColorSys::yuv2rgb(components[0], components[1], components[2], rgb.red, rgb.green, rgb.blue);
+	}
+	else
+	{
+		rgb = { components[0], components[1], components[2] };
+	}
+	return rgb;
+}
+
+///
+/// Convert a single source pixel the way the resampler did before the per format SIMD loops
+///
+ColorRgb readPixel(const std::vector<uint8_t>& data, int height, int lineLength, PixelFormat format, int x, int y)
+{
+	uint8_t components[3];
+	readComponents(data, height, lineLength, format, x, y, components);
+	return toRgb(format, components);
+}
+
+///
+/// Average the components of a block which is cut by the crop border, YUV is averaged before the conversion
+///
+ColorRgb readBlock(const std::vector<uint8_t>& data, int height, int lineLength, PixelFormat format, int xBegin, int xEnd, int yBegin, int yEnd)
+{
+	uint32_t sum[3] = { 0, 0, 0 };
+	for (int y = yBegin; y < yEnd; ++y)
+	{
+		for (int x = xBegin; x < xEnd; ++x)
+		{
+			uint8_t components[3];
+			readComponents(data, height, lineLength, format, x, y, components);
+			for (int i = 0; i < 3; ++i)
+			{
+				sum[i] += components[i];
+			}
+		}
+	}
+
+	const uint32_t count = uint32_t((xEnd - xBegin) * (yEnd - yBegin));
+	uint8_t average[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		average[i] = uint8_t((sum[i] + count / 2) / count);
+	}
+	return toRgb(format, average);
+}
+
+struct Crop { int left, right, top, bottom; };
+
+///
+/// Fill a frame of the format with random bytes, the planar formats get room for their chroma planes
+///
+std::vector<uint8_t> randomFrame(std::mt19937& random, const FormatInfo& info, int width, int height, int& lineLength)
+{
+	lineLength = (info.bytesPerPixel == 0) ? width : width * info.bytesPerPixel + 4;
+	std::vector<uint8_t> data(size_t(lineLength) * height * 2);
+	for (uint8_t& byte : data)
+	{
+		byte = uint8_t(random());
+	}
+	return data;
+}
+
+///
+/// Convert a frame with processImage() and compare every output pixel with readPixel() of the center pixel of its
+/// decimation block or, with average decimation, with the average of the block
+/// @return The count of differing pixels, -1 if the output size is wrong
+///
+int compareConversion(const std::vector<uint8_t>& data, int width, int height, int lineLength, PixelFormat format, const Crop& crop, int decimation, bool average)
+{
+	ImageResampler resampler;
+	resampler.setHorizontalPixelDecimation(decimation);
+	resampler.setVerticalPixelDecimation(decimation);
+	resampler.setCropping(crop.left, crop.right, crop.top, crop.bottom);
+	resampler.setAverageDecimation(average);
+
+	Image<ColorRgb> image(0, 0);
+	resampler.processImage(data.data(), width, height, lineLength, format, image);
+
+	const int xEnd = width - crop.right;
+	const int yEnd = height - crop.bottom;
+	const int outputWidth  = (xEnd - crop.left - (decimation >> 1) + decimation - 1) / decimation;
+	const int outputHeight = (yEnd - crop.top - (decimation >> 1) + decimation - 1) / decimation;
+	if (int(image.width()) != outputWidth || int(image.height()) != outputHeight)
+	{
+		std::cerr << "wrong output size " << image.width() << "x" << image.height() << std::endl;
+		return -1;
+	}
+
+	int mismatches = 0;
+	for (int yDest = 0; yDest < outputHeight; ++yDest)
+	{
+		for (int xDest = 0; xDest < outputWidth; ++xDest)
+		{
+			const int xBlock = crop.left + xDest * decimation;
+			const int yBlock = crop.top + yDest * decimation;
+			const ColorRgb expected = average
+					? readBlock(data, height, lineLength, format, xBlock, std::min(xBlock + decimation, xEnd), yBlock, std::min(yBlock + decimation, yEnd))
+					: readPixel(data, height, lineLength, format, xBlock + (decimation >> 1), yBlock + (decimation >> 1));
+			const ColorRgb& actual = image(unsigned(xDest), unsigned(yDest));
+			if (actual.red != expected.red || actual.green != expected.green || actual.blue != expected.blue)
+			{
+				++mismatches;
+			}
+		}
+	}
+	return mismatches;
+}
+
+///
+/// Convert random frames with point decimation, every output pixel has to match readPixel() bit exact
+///
+int TC_POINT_DECIMATION()
+{
+	int result = 0;
+	std::mt19937 random(1234);
+
+	const Crop crops[] = { { 0, 0, 0, 0 }, { 3, 5, 1, 2 }, { 7, 2, 3, 0 } };
+
+	for (const FormatInfo& info : FORMATS)
+	{
+		for (int width : { 64, 78, 101 })
+		{
+			// widths which are not a multiple of the SIMD block, the planar formats have even widths
+			if (info.bytesPerPixel == 0 && (width & 1) != 0)
+			{
+				continue;
+			}
+
+			const int height = 36;
+			int lineLength;
+			const std::vector<uint8_t> data = randomFrame(random, info, width, height, lineLength);
+
+			for (const Crop& crop : crops)
+			{
+				for (int decimation : { 1, 2 })
+				{
+					const int mismatches = compareConversion(data, width, height, lineLength, info.format, crop, decimation, false);
+					if (mismatches != 0)
+					{
+						std::cerr << info.name << ": " << mismatches << " pixels differ at width " << width << ", crop "
+								  << crop.left << "/" << crop.right << "/" << crop.top << "/" << crop.bottom
+								  << ", decimation " << decimation << std::endl;
+						result = -1;
+					}
+				}
+			}
+		}
+	}
+
+	if (result == 0)
+	{
+		std::cout << "All formats convert bit exact to the per pixel path" << std::endl;
+	}
+	return result;
+}
+
+///
+/// Convert random frames with average decimation, every output pixel has to match the rounded average of the
+/// components of its block. The crops cut the blocks at the right and bottom border.
+///
+int TC_AVERAGE_DECIMATION()
+{
+	int result = 0;
+	std::mt19937 random(4321);
+
+	const Crop crops[] = { { 0, 0, 0, 0 }, { 3, 5, 1, 2 }, { 7, 2, 3, 0 } };
+
+	for (const FormatInfo& info : FORMATS)
+	{
+		const int width = 78;
+		const int height = 36;
+		int lineLength;
+		const std::vector<uint8_t> data = randomFrame(random, info, width, height, lineLength);
+
+		for (const Crop& crop : crops)
+		{
+			for (int decimation : { 2, 3, 4, 8 })
+			{
+				const int mismatches = compareConversion(data, width, height, lineLength, info.format, crop, decimation, true);
+				if (mismatches != 0)
+				{
+					std::cerr << info.name << ": " << mismatches << " block averages differ at crop "
+							  << crop.left << "/" << crop.right << "/" << crop.top << "/" << crop.bottom
+							  << ", decimation " << decimation << std::endl;
+					result = -1;
+				}
+			}
+		}
+	}
+
+	if (result == 0)
+	{
+		std::cout << "All formats average the decimation blocks" << std::endl;
+	}
+	return result;
+}
+
+///
+/// Convert full HD frames, the rows are split into many bands of the worker pool (about 34 rows per band
+/// without decimation). The bands have to give the same output as the per pixel path.
+///
+int TC_PARALLEL_BANDS()
+{
+	int result = 0;
+	std::mt19937 random(8765);
+
+	const int width = 1920;
+	const int height = 1080;
+	const Crop crops[] = { { 0, 0, 0, 0 }, { 5, 3, 2, 7 } };
+
+	for (const FormatInfo& info : FORMATS)
+	{
+		int lineLength;
+		const std::vector<uint8_t> data = randomFrame(random, info, width, height, lineLength);
+
+		for (const Crop& crop : crops)
+		{
+			struct Mode { int decimation; bool average; };
+			for (const Mode& mode : { Mode{ 1, false }, Mode{ 2, false }, Mode{ 4, true } })
+			{
+				const int mismatches = compareConversion(data, width, height, lineLength, info.format, crop, mode.decimation, mode.average);
+				if (mismatches != 0)
+				{
+					std::cerr << info.name << ": " << mismatches << " pixels differ in full HD at crop "
+							  << crop.left << "/" << crop.right << "/" << crop.top << "/" << crop.bottom
+							  << ", decimation " << mode.decimation << (mode.average ? " (average)" : "") << std::endl;
+					result = -1;
+				}
+			}
+		}
+	}
+
+	if (result == 0)
+	{
+		std::cout << "The parallel bands convert like the per pixel path" << std::endl;
+	}
+	return result;
+}
+
+///
+/// Convert only a region into an image which holds an earlier frame, the pixels of the region have to match the
+/// full conversion and all others have to be black
+///
+int TC_REGION()
+{
+	int result = 0;
+	std::mt19937 random(5678);
+
+	const int width = 96;
+	const int height = 54;
+	const int lineLength = width * 2;
+	std::vector<uint8_t> data(size_t(lineLength) * height);
+	for (uint8_t& byte : data)
+	{
+		byte = uint8_t(random());
+	}
+
+	for (bool average : { false, true })
+	{
+		ImageResampler resampler;
+		resampler.setHorizontalPixelDecimation(2);
+		resampler.setVerticalPixelDecimation(2);
+		resampler.setAverageDecimation(average);
+
+		Image<ColorRgb> full(0, 0);
+		resampler.processImage(data.data(), width, height, lineLength, PixelFormat::YUYV, full);
+
+		// an image of a previous frame is reused
+		Image<ColorRgb> image(0, 0);
+		resampler.processImage(data.data(), width, height, lineLength, PixelFormat::YUYV, image);
+
+		// a top and a left edge
+		resampler.setRegion(QVector<QRectF>() << QRectF(0.0, 0.0, 1.0, 0.1) << QRectF(0.0, 0.0, 0.1, 1.0));
+		resampler.processImage(data.data(), width, height, lineLength, PixelFormat::YUYV, image);
+
+		int converted = 0;
+		int mismatches = 0;
+		for (unsigned y = 0; y < image.height(); ++y)
+		{
+			for (unsigned x = 0; x < image.width(); ++x)
+			{
+				const ColorRgb& actual = image(x, y);
+				const ColorRgb& expected = full(x, y);
+				const bool black = actual.red == 0 && actual.green == 0 && actual.blue == 0;
+				const bool inside = x < image.width() / 10 || y < image.height() / 10;
+				const bool same = actual.red == expected.red && actual.green == expected.green && actual.blue == expected.blue;
+
+				// the region is grown by a pixel, the pixels next to it may be converted as well
+				if ((inside && !same) || (!inside && !black && !same))
+				{
+					++mismatches;
+				}
+				converted += (!black && same) ? 1 : 0;
+			}
+		}
+
+		if (mismatches > 0 || converted >= int(image.width() * image.height()) / 2)
+		{
+			std::cerr << "Region conversion failed, " << mismatches << " pixels differ, " << converted << " pixels converted"
+					  << (average ? " with average decimation" : "") << std::endl;
+			result = -1;
+		}
+	}
+
+	if (result == 0)
+	{
+		std::cout << "Only the region is converted, the remaining pixels are black" << std::endl;
+	}
+	return result;
+}
+
+int main()
+{
+	int result = TC_POINT_DECIMATION();
+	result |= TC_AVERAGE_DECIMATION();
+	result |= TC_PARALLEL_BANDS();
+	result |= TC_REGION();
+	return result;
+}
@@ -0,0 +1,49 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+#include "BenchmarkUtils.h"
+
+// Blackborder includes
+#include <blackborder/BlackBorderDetector.h>
+
+using namespace hyperion;
+
+namespace {
+
+///
+/// Detection modes of the BlackBorderDetector
+///
+enum DetectionMode
+{
+	MODE_DEFAULT,
+	MODE_CLASSIC,
+	MODE_OSD
+};
+
+///
+/// Arguments: detection mode; the image is a letterboxed 1920x1080 frame
+///
+void BM_BlackBorderDetector_process(benchmark::State& state)
+{
+	const DetectionMode mode = DetectionMode(state.range(0));
+	const Image<ColorRgb> image = BenchmarkUtils::randomImage(1920, 1080, 140, 0);
+	const BlackBorderDetector detector(0.05);
+
+	for (auto _ : state)
+	{
+		BlackBorder border;
+		switch (mode)
+		{
+			case MODE_CLASSIC: border = detector.process_classic(image); break;
+			case MODE_OSD:     border = detector.process_osd(image); break;
+			default:           border = detector.process(image); break;
+		}
+		benchmark::DoNotOptimize(border);
+	}
+
+	const char* const labels[] = { "default", "classic", "osd" };
+	state.SetLabel(labels[mode]);
+}
+
+}
+
+BENCHMARK(BM_BlackBorderDetector_process)->ArgName("mode")->DenseRange(MODE_DEFAULT, MODE_OSD)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,90 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+#include "BenchmarkUtils.h"
+
+// QT includes
+#include <QJsonObject>
+#include <QJsonArray>
+
+// Hyperion includes
+#include <utils/hyperion.h>
+#include <hyperion/MultiColorAdjustment.h>
+#include <hyperion/LinearColorSmoothing.h>
+
+namespace {
+
+///
+/// A typical user adjusted color configuration (gamma, white point, brightness and dimmed secondary colors)
+///
+QJsonObject adjustmentConfig()
+{
+	QJsonObject config;
+	config["id"] = "default";
+	config["leds"] = "*";
+	config["white"] = QJsonArray({ 255, 230, 200 });
+	config["red"] = QJsonArray({ 255, 10, 0 });
+	config["cyan"] = QJsonArray({ 0, 230, 240 });
+	config["magenta"] = QJsonArray({ 240, 0, 220 });
+	config["yellow"] = QJsonArray({ 250, 235, 0 });
+	config["gammaRed"] = 2.2;
+	config["gammaGreen"] = 2.2;
+	config["gammaBlue"] = 2.2;
+	config["brightness"] = 80;
+	config["backlightThreshold"] = 2.0;
+	return config;
+}
+
+///
+/// Arguments: led count; every third led has a different color order
+///
+void BM_MultiColorAdjustment_applyAdjustment(benchmark::State& state)
+{
+	const unsigned ledCount = unsigned(state.range(0));
+
+	MultiColorAdjustment adjustment(ledCount);
+	adjustment.addAdjustment(hyperion::createColorAdjustment(adjustmentConfig()));
+	adjustment.setAdjustmentForLed("default", 0, ledCount - 1);
+
+	std::vector<ColorOrder> colorOrder(ledCount, ColorOrder::ORDER_RGB);
+	for (unsigned i = 0; i < ledCount; i += 3)
+		colorOrder[i] = ColorOrder::ORDER_GRB;
+	adjustment.setLedColorOrder(colorOrder);
+
+	const std::vector<ColorRgb> input = BenchmarkUtils::randomColors(ledCount);
+	std::vector<ColorRgb> ledColors;
+	ledColors.reserve(ledCount);
+
+	for (auto _ : state)
+	{
+		ledColors.assign(input.begin(), input.end());
+		adjustment.applyAdjustment(ledColors);
+		benchmark::DoNotOptimize(ledColors.data());
+	}
+	state.SetItemsProcessed(state.iterations() * ledCount);
+}
+
+///
+/// Arguments: led count; alternates between two targets so the colors never settle
+///
+void BM_LinearColorSmoothing_interpolate(benchmark::State& state)
+{
+	const size_t ledCount = size_t(state.range(0));
+	const std::vector<ColorRgb> targets[2] = {
+		BenchmarkUtils::randomColors(ledCount, BenchmarkUtils::SEED),
+		BenchmarkUtils::randomColors(ledCount, BenchmarkUtils::SEED + 1)
+	};
+	std::vector<ColorRgb> ledColors = BenchmarkUtils::randomColors(ledCount, BenchmarkUtils::SEED + 2);
+
+	size_t iteration = 0;
+	for (auto _ : state)
+	{
+		LinearColorSmoothing::interpolate(ledColors, targets[iteration++ & 1], 0.4f);
+		benchmark::DoNotOptimize(ledColors.data());
+	}
+	state.SetItemsProcessed(state.iterations() * ledCount);
+}
+
+}
+
+BENCHMARK(BM_MultiColorAdjustment_applyAdjustment)->ArgName("leds")->Arg(100)->Arg(500)->Arg(2000);
+BENCHMARK(BM_LinearColorSmoothing_interpolate)->ArgName("leds")->Arg(100)->Arg(500)->Arg(2000);
@@ -0,0 +1,85 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+#include "BenchmarkUtils.h"
+
+// Hyperion includes
+#include <utils/ImageResampler.h>
+#include <utils/PixelFormat.h>
+
+namespace {
+
+struct FormatInfo
+{
+	PixelFormat format;
+	/// bytes per pixel of a packed format or of the luma plane of a planar YUV 4:2:0 format
+	int bytesPerPixel;
+	/// a luma plane followed by the chroma planes of half the size each
+	bool planar;
+	const char* name;
+};
+
+const FormatInfo FORMATS[] = {
+	{ PixelFormat::YUYV,  2, false, "yuyv" },
+	{ PixelFormat::UYVY,  2, false, "uyvy" },
+	{ PixelFormat::BGR16, 2, false, "bgr16" },
+	{ PixelFormat::BGR24, 3, false, "bgr24" },
+	{ PixelFormat::RGB24, 3, false, "rgb24" },
+	{ PixelFormat::RGB32, 4, false, "rgb32" },
+	{ PixelFormat::BGR32, 4, false, "bgr32" },
+	{ PixelFormat::NV12,  1, true,  "nv12" },
+	{ PixelFormat::NV21,  1, true,  "nv21" },
+	{ PixelFormat::I420,  1, true,  "i420" },
+	{ PixelFormat::YV12,  1, true,  "yv12" },
+};
+
+///
+/// Arguments: index into FORMATS, decimation, average decimation (box filter) instead of the center pixel
+///
+void BM_ImageResampler_processImage(benchmark::State& state)
+{
+	const FormatInfo& info = FORMATS[state.range(0)];
+	const int decimation = int(state.range(1));
+	const bool averageDecimation = state.range(2) != 0;
+	const int width = 1920;
+	const int height = 1080;
+	const int lineLength = width * info.bytesPerPixel;
+	const size_t frameSize = info.planar ? size_t(lineLength) * height * 3 / 2 : size_t(lineLength) * height;
+
+	const std::vector<uint8_t> data = BenchmarkUtils::randomBytes(frameSize);
+
+	ImageResampler resampler;
+	resampler.setHorizontalPixelDecimation(decimation);
+	resampler.setVerticalPixelDecimation(decimation);
+	resampler.setAverageDecimation(averageDecimation);
+
+	Image<ColorRgb> outputImage(width / decimation, height / decimation);
+	for (auto _ : state)
+	{
+		resampler.processImage(data.data(), width, height, lineLength, info.format, outputImage);
+		benchmark::DoNotOptimize(outputImage.memptr());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetLabel(info.name);
+	state.SetItemsProcessed(state.iterations() * outputImage.width() * outputImage.height());
+	state.SetBytesProcessed(state.iterations() * int64_t(frameSize));
+}
+
+void resamplerArguments(benchmark::internal::Benchmark* benchmark)
+{
+	for (int format = 0; format < int(sizeof(FORMATS) / sizeof(FORMATS[0])); ++format)
+	{
+		for (int decimation : { 1, 8 })
+		{
+			benchmark->Args({ format, decimation, 0 });
+		}
+		for (int decimation : { 8, 16 })
+		{
+			benchmark->Args({ format, decimation, 1 });
+		}
+	}
+}
+
+}
+
+BENCHMARK(BM_ImageResampler_processImage)->ArgNames({ "format", "decimation", "averageDecimation" })->Apply(resamplerArguments)->Unit(benchmark::kMicrosecond);
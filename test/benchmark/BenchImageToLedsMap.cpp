@@ -0,0 +1,74 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+#include "BenchmarkUtils.h"
+
+// Hyperion includes
+#include <hyperion/ImageToLedsMap.h>
+
+using namespace hyperion;
+
+namespace {
+
+///
+/// Arguments: image width, image height; 80 x 45 leds along the edges.
+/// Large images are spread over the worker pool, so the wall clock time is reported.
+///
+void BM_ImageToLedsMap_multicolor(benchmark::State& state)
+{
+	const unsigned width = unsigned(state.range(0));
+	const unsigned height = unsigned(state.range(1));
+	const Image<ColorRgb> image = BenchmarkUtils::randomImage(width, height);
+	const ImageToLedsMap map(width, height, 0, 0, BenchmarkUtils::classicLayout(80, 45));
+
+	std::vector<ColorRgb> ledColors(map.getMeanLedColor(image).size());
+	for (auto _ : state)
+	{
+		map.getMeanLedColor(image, ledColors);
+		benchmark::DoNotOptimize(ledColors.data());
+	}
+	state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_ImageToLedsMap_multicolorIntegral(benchmark::State& state)
+{
+	const unsigned width = unsigned(state.range(0));
+	const unsigned height = unsigned(state.range(1));
+	const Image<ColorRgb> image = BenchmarkUtils::randomImage(width, height);
+	ImageToLedsMap map(width, height, 0, 0, BenchmarkUtils::classicLayout(80, 45));
+
+	std::vector<ColorRgb> ledColors(map.getMeanLedColor(image).size());
+	std::vector<uint32_t> integral;
+	for (auto _ : state)
+	{
+		map.getMeanLedColorIntegral(image, integral, ledColors);
+		benchmark::DoNotOptimize(ledColors.data());
+	}
+	state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void BM_ImageToLedsMap_unicolor(benchmark::State& state)
+{
+	const unsigned width = unsigned(state.range(0));
+	const unsigned height = unsigned(state.range(1));
+	const Image<ColorRgb> image = BenchmarkUtils::randomImage(width, height);
+	const ImageToLedsMap map(width, height, 0, 0, BenchmarkUtils::classicLayout(80, 45));
+
+	std::vector<ColorRgb> ledColors(map.getUniLedColor(image).size());
+	for (auto _ : state)
+	{
+		map.getUniLedColor(image, ledColors);
+		benchmark::DoNotOptimize(ledColors.data());
+	}
+	state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+void imageSizes(benchmark::internal::Benchmark* benchmark)
+{
+	benchmark->Args({ 160, 90 })->Args({ 640, 360 })->Args({ 1920, 1080 });
+}
+
+}
+
+BENCHMARK(BM_ImageToLedsMap_multicolor)->ArgNames({ "width", "height" })->Apply(imageSizes)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_ImageToLedsMap_multicolorIntegral)->ArgNames({ "width", "height" })->Apply(imageSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ImageToLedsMap_unicolor)->ArgNames({ "width", "height" })->Apply(imageSizes)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,101 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+#include "BenchmarkUtils.h"
+
+// QT includes
+#include <QJsonObject>
+
+#include <HyperionConfig.h>
+
+// LedDevice includes
+#include <leddevice/dev_net/LedDeviceUdpE131.h>
+#ifdef ENABLE_SPIDEV
+#include <leddevice/dev_spi/LedDeviceWs2812SPI.h>
+#endif
+
+namespace {
+
+///
+/// Exposes the encoder of a LedDevice. The device is initialised but not opened,
+/// so write() measures the protocol encoding plus the transport call.
+///
+template <typename Device_T>
+class BenchmarkDevice : public Device_T
+{
+public:
+	explicit BenchmarkDevice(const QJsonObject& deviceConfig)
+		: Device_T(deviceConfig)
+	{
+	}
+
+	using Device_T::init;
+	using Device_T::write;
+};
+
+QJsonObject deviceConfig(const QString& type, int ledCount)
+{
+	QJsonObject config;
+	config["type"] = type;
+	config["currentLedCount"] = ledCount;
+	config["latchTime"] = 0;
+	config["rewriteTime"] = 0;
+	return config;
+}
+
+///
+/// Arguments: led count; the packets are sent to the discard port of localhost
+///
+void BM_LedDeviceUdpE131_write(benchmark::State& state)
+{
+	const int ledCount = int(state.range(0));
+	QJsonObject config = deviceConfig("e131", ledCount);
+	config["host"] = "127.0.0.1";
+	config["port"] = 9;
+	config["cid"] = "{2d6f5f8c-6a6e-4d63-9c3e-1f1bbad0e131}";
+
+	BenchmarkDevice<LedDeviceUdpE131> device(config);
+	if (!device.init(config))
+	{
+		state.SkipWithError("E1.31 device initialisation failed");
+		return;
+	}
+
+	const std::vector<ColorRgb> ledColors = BenchmarkUtils::randomColors(size_t(ledCount));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(device.write(ledColors));
+	}
+	state.SetItemsProcessed(state.iterations() * ledCount);
+}
+
+#ifdef ENABLE_SPIDEV
+///
+/// Arguments: led count; no SPI device is opened, only the bit encoding is measured
+///
+void BM_LedDeviceWs2812SPI_write(benchmark::State& state)
+{
+	const int ledCount = int(state.range(0));
+	const QJsonObject config = deviceConfig("ws2812spi", ledCount);
+
+	BenchmarkDevice<LedDeviceWs2812SPI> device(config);
+	if (!device.init(config))
+	{
+		state.SkipWithError("WS2812 SPI device initialisation failed");
+		return;
+	}
+
+	const std::vector<ColorRgb> ledColors = BenchmarkUtils::randomColors(size_t(ledCount));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(device.write(ledColors));
+	}
+	state.SetItemsProcessed(state.iterations() * ledCount);
+}
+#endif
+
+}
+
+BENCHMARK(BM_LedDeviceUdpE131_write)->ArgName("leds")->Arg(170)->Arg(510)->Arg(1020)->Unit(benchmark::kMicrosecond);
+#ifdef ENABLE_SPIDEV
+BENCHMARK(BM_LedDeviceWs2812SPI_write)->ArgName("leds")->Arg(100)->Arg(500)->Arg(2000)->Unit(benchmark::kMicrosecond);
+#endif
@@ -0,0 +1,29 @@
+// Benchmark includes
+#include <benchmark/benchmark.h>
+
+// QT includes
+#include <QCoreApplication>
+
+// Hyperion includes
+#include <utils/Logger.h>
+
+///
+/// Runs all registered benchmarks. Supports the google benchmark command line,
+/// use --benchmark_out=<file> --benchmark_out_format=json for machine readable results.
+///
+int main(int argc, char** argv)
+{
+	// devices and sockets expect an application instance
+	QCoreApplication app(argc, argv);
+
+	// keep the log output of the measured code out of the results
+	Logger::setLogLevel(Logger::WARNING);
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// STL includes
+#include <random>
+#include <vector>
+
+// Hyperion includes
+#include <utils/Image.h>
+#include <utils/ColorRgb.h>
+#include <hyperion/LedString.h>
+
+///
+/// Input data for the benchmarks. All data is generated from a fixed seed,
+/// so every run and every build measures identical input.
+///
+namespace BenchmarkUtils
+{
+	const unsigned SEED = 20201016;
+
+	///
+	/// Fill a memory block with reproducible random bytes
+	///
+	inline std::vector<uint8_t> randomBytes(size_t size, unsigned seed = SEED)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_int_distribution<int> distribution(0, 255);
+
+		std::vector<uint8_t> data(size);
+		for (uint8_t& value : data)
+			value = uint8_t(distribution(generator));
+		return data;
+	}
+
+	///
+	/// Create a reproducible random image, optionally with black borders (letterbox/pillarbox)
+	///
+	inline Image<ColorRgb> randomImage(unsigned width, unsigned height, unsigned topBorder = 0, unsigned leftBorder = 0)
+	{
+		const std::vector<uint8_t> data = randomBytes(size_t(width) * height * 3);
+
+		Image<ColorRgb> image(width, height);
+		ColorRgb* pixel = image.memptr();
+		for (unsigned y = 0; y < height; ++y)
+		{
+			for (unsigned x = 0; x < width; ++x, ++pixel)
+			{
+				const bool border = y < topBorder || y >= height - topBorder || x < leftBorder || x >= width - leftBorder;
+				const size_t idx = (size_t(y) * width + x) * 3;
+				*pixel = border ? ColorRgb::BLACK : ColorRgb{data[idx], data[idx + 1], data[idx + 2]};
+			}
+		}
+		return image;
+	}
+
+	///
+	/// Create reproducible random led colors
+	///
+	inline std::vector<ColorRgb> randomColors(size_t ledCount, unsigned seed = SEED)
+	{
+		const std::vector<uint8_t> data = randomBytes(ledCount * 3, seed);
+
+		std::vector<ColorRgb> colors(ledCount);
+		for (size_t i = 0; i < ledCount; ++i)
+			colors[i] = ColorRgb{data[i * 3], data[i * 3 + 1], data[i * 3 + 2]};
+		return colors;
+	}
+
+	///
+	/// Create a classic frame layout with leds along all four edges, each led covers 8% of the image depth
+	///
+	/// @param horizontalLeds The number of leds along the top and along the bottom edge
+	/// @param verticalLeds The number of leds along the left and along the right edge
+	///
+	inline std::vector<Led> classicLayout(unsigned horizontalLeds, unsigned verticalLeds)
+	{
+		const double depth = 0.08;
+		std::vector<Led> leds;
+
+		auto addLed = [&leds](double minX, double maxX, double minY, double maxY)
+		{
+			leds.push_back(Led{minX, maxX, minY, maxY, ColorOrder::ORDER_RGB});
+		};
+
+		for (unsigned i = 0; i < horizontalLeds; ++i)
+			addLed(double(i) / horizontalLeds, double(i + 1) / horizontalLeds, 0.0, depth);
+		for (unsigned i = 0; i < verticalLeds; ++i)
+			addLed(1.0 - depth, 1.0, double(i) / verticalLeds, double(i + 1) / verticalLeds);
+		for (unsigned i = horizontalLeds; i > 0; --i)
+			addLed(double(i - 1) / horizontalLeds, double(i) / horizontalLeds, 1.0 - depth, 1.0);
+		for (unsigned i = verticalLeds; i > 0; --i)
+			addLed(0.0, depth, double(i - 1) / verticalLeds, double(i) / verticalLeds);
+
+		return leds;
+	}
+}